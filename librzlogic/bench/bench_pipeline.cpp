@@ -0,0 +1,369 @@
+#include <benchmark/benchmark.h>
+#include "generators.hpp"
+#include "logic.hpp"
+#include "parser.hpp"
+#include "prover.hpp"
+#include "thread_pool.hpp"
+#include "tokenizer.hpp"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+using namespace rzlogic;
+
+// (forall x (implies (Pi x) (exists y (and (Ri x y) (Pi+1 y))))) for i < n,
+// every stage of the normalization has work to do on each of them
+static std::vector<std::string> TheoryPremises(int n)
+{
+    std::vector<std::string> premises;
+    for (int i = 0; i < n; i++)
+    {
+        std::string p = "P" + std::to_string(i);
+        std::string next = "P" + std::to_string(i + 1);
+        premises.push_back("(forall x (implies (" + p + " x) (exists y (and (R" + std::to_string(i) +
+                           " x y) (" + next + " y)))))");
+    }
+    return premises;
+}
+
+// the conjunction of the n premises
+static std::string TheoryText(int n)
+{
+    std::vector<std::string> premises = TheoryPremises(n);
+
+    std::string text;
+    for (int i = 0; i < n; i++) {
+        text += (i + 1 < n) ? "(and " + premises[i] + " " : premises[i];
+    }
+    text += std::string(n - 1, ')');
+    return text;
+}
+
+// the theory after the stages before stage
+static Formula *TheoryBefore(int n, void (*stage)(Formula*))
+{
+    Formula *f = Parser(TheoryText(n)).Parse();
+
+    void (*stages[])(Formula*) = {NormalizeFormula, MakePrenexNormalForm, MakeSkolemNormalForm, MakeConjunctiveNormalForm};
+    for (auto *previous : stages)
+    {
+        if (previous == stage) break;
+        previous(f);
+    }
+    return f;
+}
+
+// P(x1 .. xn) against not P(f(a) .. f(a))
+static void UnificationPair(int n, Formula *&f1, Formula *&f2)
+{
+    std::string vars, terms;
+    for (int i = 0; i < n; i++)
+    {
+        vars += " x" + std::to_string(i);
+        terms += " (f a)";
+    }
+    f1 = Parser("(P" + vars + ")").Parse();
+    f2 = Parser("(not (P" + terms + "))").Parse();
+}
+
+// clauses of n + 1 literals, the complementary pair comes last
+static void ResolutionPair(int n, Formula *&f1, Formula *&f2)
+{
+    std::string text1 = "(P a)", text2 = "(not (P a))";
+    for (int i = 0; i < n; i++)
+    {
+        text1 = "(or (L" + std::to_string(i) + " a) " + text1 + ")";
+        text2 = "(or (K" + std::to_string(i) + " b) " + text2 + ")";
+    }
+    f1 = Parser(text1).Parse();
+    f2 = Parser(text2).Parse();
+}
+
+// P0(a), Pi(a) -> Pi+1(a), not Pn(a)
+static std::vector<Formula*> ChainProblem(int n)
+{
+    std::vector<Formula*> clauses = {Parser("(P0 a)").Parse()};
+    for (int i = 0; i < n; i++)
+    {
+        clauses.push_back(Parser("(or (not (P" + std::to_string(i) + " a)) (P" + std::to_string(i + 1) + " a))").Parse());
+    }
+    clauses.push_back(Parser("(not (P" + std::to_string(n) + " a))").Parse());
+    return clauses;
+}
+
+static void BM_Parse(benchmark::State &state)
+{
+    std::string text = TheoryText(state.range(0));
+    for (auto _ : state)
+    {
+        Formula *f = Parser(text).Parse();
+        benchmark::DoNotOptimize(f);
+
+        state.PauseTiming();
+        DeleteFormula(f);
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_Parse)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// n ground facts (Ri ci di) one per line, the shape of a bulk fact base
+static std::vector<std::string> FactLines(int n)
+{
+    std::vector<std::string> lines;
+    for (int i = 0; i < n; i++)
+    {
+        std::string index = std::to_string(i);
+        lines.push_back("(R" + std::to_string(i % 16) + " c" + index + " d" + index + ")");
+    }
+    return lines;
+}
+
+// premise strings, a Parser for every one
+static void BM_ClausifyFacts(benchmark::State &state)
+{
+    std::vector<std::string> lines = FactLines(state.range(0));
+
+    std::vector<Formula*> clauses;
+    for (auto _ : state)
+    {
+        ClausifyPremises(lines, clauses);
+
+        state.PauseTiming();
+        for (Formula *f : clauses) DeleteFormula(f);
+        clauses.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+}
+BENCHMARK(BM_ClausifyFacts)->RangeMultiplier(8)->Range(64, 32768);
+
+// the same facts streamed from a file, Skolem symbols checked against the
+// interned names
+static void BM_ClausifyPremiseFile(benchmark::State &state)
+{
+    std::vector<std::string> lines = FactLines(state.range(0));
+
+    std::string path = "rzlogic_bench_facts.txt";
+    {
+        std::ofstream out(path);
+        for (const std::string &line : lines) out << line << "\n";
+    }
+
+    std::vector<Formula*> clauses;
+    for (auto _ : state)
+    {
+        ClausifyPremiseFile(path, clauses);
+
+        state.PauseTiming();
+        for (Formula *f : clauses) DeleteFormula(f);
+        clauses.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_ClausifyPremiseFile)->RangeMultiplier(8)->Range(64, 32768);
+
+// the premises of the theory on state.range(1) threads, 1 runs without a pool
+static void BM_ClausifyPremisesParallel(benchmark::State &state)
+{
+    std::vector<std::string> premises = TheoryPremises(state.range(0));
+
+    std::unique_ptr<ThreadPool> pool;
+    if (state.range(1) > 1) pool = std::make_unique<ThreadPool>(state.range(1));
+
+    std::vector<Formula*> clauses;
+    for (auto _ : state)
+    {
+        ClausifyPremises(premises, clauses, pool.get());
+
+        state.PauseTiming();
+        for (Formula *f : clauses) DeleteFormula(f);
+        clauses.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * premises.size());
+}
+BENCHMARK(BM_ClausifyPremisesParallel)->ArgsProduct({{16384}, {1, 2, 4}})->UseRealTime();
+
+// the tokens of the facts alone, with every kernel the CPU runs
+static void BM_Tokenize(benchmark::State &state, ScanKernel kernel)
+{
+    if (kernel > BestScanKernel())
+    {
+        state.SkipWithError("kernel not supported by the CPU");
+        return;
+    }
+
+    std::string text;
+    for (const std::string &line : FactLines(state.range(0))) text += line + "\n";
+
+    for (auto _ : state)
+    {
+        Tokenizer tokenizer(text.data(), text.size(), true, kernel);
+        size_t tokens = 0;
+        while (tokenizer.Next().type != TokenType::END) tokens++;
+        benchmark::DoNotOptimize(tokens);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK_CAPTURE(BM_Tokenize, scalar, ScanKernel::SCALAR)->Arg(32768);
+BENCHMARK_CAPTURE(BM_Tokenize, sse2, ScanKernel::SSE2)->Arg(32768);
+BENCHMARK_CAPTURE(BM_Tokenize, avx2, ScanKernel::AVX2)->Arg(32768);
+
+// times stage on a fresh copy of its input every iteration
+static void StageBenchmark(benchmark::State &state, void (*stage)(Formula*))
+{
+    Formula *input = TheoryBefore(state.range(0), stage);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Formula *f = CloneFormula(input);
+        state.ResumeTiming();
+
+        stage(f);
+        benchmark::DoNotOptimize(f);
+
+        state.PauseTiming();
+        DeleteFormula(f);
+        state.ResumeTiming();
+    }
+    DeleteFormula(input);
+    state.SetComplexityN(state.range(0));
+}
+
+static void BM_NormalizeFormula(benchmark::State &state) { StageBenchmark(state, NormalizeFormula); }
+static void BM_MakePrenexNormalForm(benchmark::State &state) { StageBenchmark(state, MakePrenexNormalForm); }
+static void BM_MakeConjunctiveNormalForm(benchmark::State &state) { StageBenchmark(state, MakeConjunctiveNormalForm); }
+
+static void BM_MakeSkolemNormalForm(benchmark::State &state)
+{
+    StageBenchmark(state, [](Formula *f) { MakeSkolemNormalForm(f); });
+}
+
+BENCHMARK(BM_NormalizeFormula)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+BENCHMARK(BM_MakePrenexNormalForm)->RangeMultiplier(4)->Range(4, 256)->Complexity();
+BENCHMARK(BM_MakeSkolemNormalForm)->RangeMultiplier(4)->Range(4, 256)->Complexity();
+BENCHMARK(BM_MakeConjunctiveNormalForm)->RangeMultiplier(4)->Range(4, 256)->Complexity();
+
+static void BM_Unificate(benchmark::State &state)
+{
+    Formula *f1, *f2;
+    UnificationPair(state.range(0), f1, f2);
+
+    // Unificate rewrites its arguments
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Formula *c1 = CloneFormula(f1);
+        Formula *c2 = CloneFormula(f2);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(Unificate(c1, c2));
+
+        state.PauseTiming();
+        DeleteFormula(c1);
+        DeleteFormula(c2);
+        state.ResumeTiming();
+    }
+    DeleteFormula(f1);
+    DeleteFormula(f2);
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_Unificate)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+static void BM_FindResolver(benchmark::State &state)
+{
+    Formula *f1, *f2;
+    ResolutionPair(state.range(0), f1, f2);
+
+    for (auto _ : state)
+    {
+        Formula *resolver = FindResolver(f1, f2);
+        benchmark::DoNotOptimize(resolver);
+
+        state.PauseTiming();
+        DeleteFormula(resolver);
+        state.ResumeTiming();
+    }
+    DeleteFormula(f1);
+    DeleteFormula(f2);
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_FindResolver)->RangeMultiplier(4)->Range(4, 256)->Complexity();
+
+static void BM_ResolutionStep(benchmark::State &state)
+{
+    Formula *f1, *f2;
+    ResolutionPair(state.range(0), f1, f2);
+    Formula *resolver = FindResolver(f1, f2);
+
+    for (auto _ : state)
+    {
+        Formula *res = ResolutionStep(f1, f2, resolver);
+        benchmark::DoNotOptimize(res);
+
+        state.PauseTiming();
+        DeleteFormula(res);
+        state.ResumeTiming();
+    }
+    DeleteFormula(resolver);
+    DeleteFormula(f1);
+    DeleteFormula(f2);
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ResolutionStep)->RangeMultiplier(4)->Range(4, 256)->Complexity();
+
+static void BM_MakeResolution(benchmark::State &state)
+{
+    std::vector<Formula*> premises = ChainProblem(state.range(0));
+
+    for (auto _ : state)
+    {
+        std::vector<ResolutionStepInfo> history;
+        ProofResult result = MakeResolution(premises, history, ResolutionOptions());
+        benchmark::DoNotOptimize(result);
+
+        state.PauseTiming();
+        DeleteHistory(history);
+        state.ResumeTiming();
+    }
+    for (Formula *f : premises) DeleteFormula(f);
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MakeResolution)->RangeMultiplier(2)->Range(4, 32)->Complexity()->Unit(benchmark::kMillisecond);
+
+// the whole pipeline on a generated family, under a clause budget
+static void BM_GeneratedProblem(benchmark::State &state, const std::string &family)
+{
+    GeneratedProblem problem = GenerateProblem(family, state.range(0));
+
+    ResolutionOptions options;
+    options.limits.max_generated = 20000;
+
+    for (auto _ : state)
+    {
+        std::vector<Formula*> clauses;
+        std::vector<ResolutionStepInfo> history;
+
+        ClausifyPremises(problem.premises, clauses);
+        ProofResult result = MakeResolution(clauses, history, options);
+        benchmark::DoNotOptimize(result);
+
+        state.PauseTiming();
+        DeleteHistory(history);
+        for (Formula *f : clauses) DeleteFormula(f);
+        state.ResumeTiming();
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK_CAPTURE(BM_GeneratedProblem, pigeonhole, std::string("pigeonhole"))->DenseRange(1, 4)->Complexity();
+BENCHMARK_CAPTURE(BM_GeneratedProblem, chain, std::string("chain"))->RangeMultiplier(2)->Range(2, 16)->Complexity();
+BENCHMARK_CAPTURE(BM_GeneratedProblem, skolem, std::string("skolem"))->DenseRange(1, 8)->Complexity();
+BENCHMARK_CAPTURE(BM_GeneratedProblem, distribution, std::string("distribution"))->DenseRange(1, 6)->Complexity();
+BENCHMARK_CAPTURE(BM_GeneratedProblem, facts, std::string("facts"))->RangeMultiplier(2)->Range(4, 64)->Complexity();
+BENCHMARK_CAPTURE(BM_GeneratedProblem, nonterminating, std::string("nonterminating"))->DenseRange(1, 4)->Complexity();
+
+BENCHMARK_MAIN();
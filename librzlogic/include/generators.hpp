@@ -0,0 +1,50 @@
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+#include "logic.hpp"
+#include <string>
+#include <vector>
+
+namespace rzlogic {
+
+// A synthetic problem in the text form make_resolution takes. expected is
+// the right answer: PROVED for unsatisfiable families, UNKNOWN for
+// satisfiable sets whose saturation never ends and needs a limit.
+struct GeneratedProblem
+{
+    std::string              name;
+    std::vector<std::string> premises;
+    ProofResult              expected = ProofResult::PROVED;
+};
+
+// holes + 1 pigeons in holes holes, exponential for resolution
+GeneratedProblem PigeonholeProblem(int holes);
+
+// (P0 a), P0 -> P1 -> ... -> Plength, (not (Plength a))
+GeneratedProblem ImplicationChainProblem(int length);
+
+// depth alternations of forall and exists, the Skolem functions take up
+// to depth arguments, refuted by the negated matrix
+GeneratedProblem SkolemNestingProblem(int depth);
+
+// (or (and A1 B1) (or ... (and Awidth Bwidth))) and the negated atoms,
+// CNF turns the disjunction into 2^width clauses
+GeneratedProblem DistributionProblem(int width);
+
+// facts ground (Human ci) facts, a chain of rules rules long, the goal
+// needs the last fact
+GeneratedProblem FactBaseProblem(int facts, int rules);
+
+// count independent successor rules (Pi a), Pi x -> Pi (fi x), every
+// one derives clauses forever
+GeneratedProblem NonTerminatingProblem(int count);
+
+// The families by name: "pigeonhole", "chain", "skolem", "distribution",
+// "facts" (with size / 4 + 1 rules) and "nonterminating". Throws
+// std::runtime_error for an unknown family.
+GeneratedProblem GenerateProblem(const std::string &family, int size);
+const std::vector<std::string> &GeneratorFamilies();
+
+} // namespace rzlogic
+
+#endif
@@ -1,7 +1,13 @@
 #ifndef LOGIC_HPP
 #define LOGIC_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <scoped_allocator>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -36,6 +42,91 @@ struct Formula
     Formula(FormulaType type, std::string str) : type(type), str(str) {}
     Formula(FormulaType type) : type(type) {}
     Formula() {}
+
+    // counted, see FormulaAllocations
+    static void *operator new(size_t size);
+    static void  operator delete(void *p);
+};
+
+// Formula nodes allocated by the calling thread so far. Stages tell how
+// many terms they built from the difference before and after.
+size_t FormulaAllocations();
+
+// Bytes of a search by what holds them
+struct MemoryUsage
+{
+    size_t terms   = 0; // formula nodes of the clauses with their child arrays and names
+    size_t clauses = 0; // per clause arrays of the store
+    size_t index   = 0; // literal index and passive queues
+    size_t history = 0; // proof steps handed out by the last search
+
+    size_t Total() const { return terms + clauses + index + history; }
+};
+
+// Live and peak bytes of one store, updated by the thread owning it
+class MemoryAccount
+{
+private:
+    MemoryUsage live;
+    MemoryUsage peak;           // every category at its largest
+    size_t      peak_total = 0; // all of them at once
+
+public:
+    void Allocate(size_t MemoryUsage::*category, size_t bytes)
+    {
+        live.*category += bytes;
+        peak.*category  = std::max(peak.*category, live.*category);
+        peak_total      = std::max(peak_total, live.Total());
+    }
+
+    void Release(size_t MemoryUsage::*category, size_t bytes) { live.*category -= bytes; }
+
+    void Set(size_t MemoryUsage::*category, size_t bytes)
+    {
+        if (bytes > live.*category) Allocate(category, bytes - live.*category);
+        else                        Release(category, live.*category - bytes);
+    }
+
+    const MemoryUsage &Live() const { return live; }
+    const MemoryUsage &Peak() const { return peak; }
+    size_t PeakTotal() const { return peak_total; }
+};
+
+// std::allocator that books what it hands out to a category of an account
+template <typename T>
+struct AccountedAllocator
+{
+    using value_type = T;
+
+    MemoryAccount *account;
+    size_t MemoryUsage::*category;
+
+    AccountedAllocator(MemoryAccount *account, size_t MemoryUsage::*category) : account(account), category(category) {}
+
+    template <typename U>
+    AccountedAllocator(const AccountedAllocator<U> &other) : account(other.account), category(other.category) {}
+
+    T *allocate(size_t n)
+    {
+        T *p = std::allocator<T>().allocate(n);
+        account->Allocate(category, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        account->Release(category, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const AccountedAllocator<U> &other) const
+    {
+        return account == other.account && category == other.category;
+    }
+
+    template <typename U>
+    bool operator!=(const AccountedAllocator<U> &other) const { return !(*this == other); }
 };
 
 struct ResolutionStepInfo
@@ -43,20 +134,297 @@ struct ResolutionStepInfo
     Formula *premise1;
     Formula *premise2;
     Formula *resolvent;
+
+    // clause ids in the inference DAG, premises are numbered from 0 in input order
+    int premise1_id  = -1;
+    int premise2_id  = -1;
+    int resolvent_id = -1;
+};
+
+// a node of the inference DAG, the premises have no parents
+struct ClauseParents
+{
+    int parent1 = -1;
+    int parent2 = -1;
+};
+
+class ProofLog;
+
+enum class ProofResult
+{
+    PROVED,     // the empty clause was derived
+    SATURATED,  // no new clauses can be derived, there is no refutation
+    UNKNOWN     // a limit was hit or the search was cancelled
+};
+
+// Shared handle: copies observe the same flag, so the search can be stopped
+// from any thread. A child is also cancelled together with its parent.
+class CancellationToken
+{
+private:
+    struct State
+    {
+        std::atomic<bool>      cancelled{false};
+        std::shared_ptr<State> parent;
+    };
+
+    std::shared_ptr<State> state;
+
+public:
+    CancellationToken() : state(std::make_shared<State>()) {}
+
+    void Cancel() const { state->cancelled = true; }
+    bool IsCancelled() const
+    {
+        for (State *s = state.get(); s; s = s->parent.get()) {
+            if (s->cancelled.load(std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    CancellationToken Child() const
+    {
+        CancellationToken child;
+        child.state->parent = state;
+        return child;
+    }
+};
+
+// 0 means unlimited
+struct ResolutionLimits
+{
+    double max_seconds    = 0;  // wall time of the search
+    size_t max_generated  = 0;  // resolvents generated
+    size_t max_memory     = 0;  // bytes held by the store, MemoryUsage::Total
+    int    max_term_depth = 0;  // deeper resolvents are dropped
+};
+
+// State of a running search, see ResolutionOptions::progress
+struct ProgressInfo
+{
+    double seconds   = 0; // since the search started
+    size_t generated = 0; // resolvents generated
+    size_t kept      = 0; // resolvents that survived the redundancy checks
+    size_t clauses   = 0; // clauses in the store
+    size_t active    = 0;
+    size_t passive   = 0;
+    size_t memory    = 0; // bytes held by the store, as limits.max_memory counts them
+
+    // unit clauses and the empty clause derived since the previous report,
+    // valid during the call
+    std::vector<Formula*> units;
+};
+
+// What the stages of a proof did, see ResolutionOptions::statistics and
+// the Clausify functions. Times are seconds spent by all threads in a
+// stage, with a pool they can add up to more than the wall time.
+struct ProofStatistics
+{
+    // clausification
+    double parse_seconds     = 0;
+    double normalize_seconds = 0;
+    double prenex_seconds    = 0;
+    double skolem_seconds    = 0; // with filling the symbol table
+    double cnf_seconds       = 0; // with dropping the quantifiers and splitting
+
+    // the search
+    double resolution_seconds    = 0;
+    size_t generated             = 0; // resolvents
+    size_t kept                  = 0;
+    size_t subsumed              = 0; // resolvents subsumed by a clause of the store
+    size_t tautologies           = 0;
+    size_t unification_attempts  = 0;
+    size_t unification_successes = 0;
+    size_t index_hits            = 0; // partners the literal index offered for a given clause
+    size_t peak_clauses          = 0;
+
+    size_t term_allocations = 0; // Formula nodes built by all stages
+
+    // bytes of the clause store at its largest, as a whole and per category
+    size_t      peak_memory = 0;
+    MemoryUsage peak_usage;
+
+    // sums, the peaks are the larger ones
+    void Add(const ProofStatistics &other);
+};
+
+struct ResolutionOptions
+{
+    // threads generating the inferences of the given clause, 1 runs them inline.
+    // The proof does not depend on this value.
+    int threads = 1;
+
+    // every (weight_ratio + 1)-th given clause is the oldest passive clause,
+    // the others are the lightest ones. 0 selects by age only.
+    int weight_ratio = 0;
+
+    // resolve only when one of the parents descends from the negative input
+    // clauses (the set of support)
+    bool set_of_support = false;
+
+    // resolve only on the maximal literal of both parents
+    bool ordered = false;
+
+    ResolutionLimits  limits;
+    CancellationToken cancel;
+
+    // called on the searching thread between given clauses, e.g. to turn
+    // pending signals into cancel.Cancel()
+    std::function<void()> poll;
+
+    // receives the input clauses and every kept inference as it happens
+    ProofLog *log = nullptr;
+
+    // the counters of the search are added to it
+    ProofStatistics *statistics = nullptr;
+
+    // called on the searching thread between given clauses at most every
+    // progress_interval seconds, and once more when the search ends
+    std::function<void(const ProgressInfo&)> progress;
+    double progress_interval = 0.5;
+};
+
+// Names of the predicates, functions and constants of a problem. Skolem
+// symbols made against a table do not clash with anything it has seen.
+class SymbolTable
+{
+private:
+    std::set<std::string> names;
+
+    // the first index UniqueName tries for a base, the ones below are taken
+    std::map<std::string, int> next_index;
+
+public:
+    void Add(Formula *f);
+    void Insert(const std::string &name) { names.insert(name); }
+    bool Contains(const std::string &name) const { return names.count(name) > 0; }
+    size_t Size() const { return names.size(); }
+    const std::set<std::string> &Names() const { return names; }
+
+    // base, base1, base2 ... whichever is free first, the name is added
+    std::string UniqueName(const std::string &base);
+};
+
+// Where a SaturationState was, everything added later is forgotten on Restore
+struct SaturationCheckpoint
+{
+    size_t clauses = 0;
+    size_t active  = 0;
+    int    picks   = 0;
+};
+
+// Contents of a SaturationState, the index and the passive queues follow
+// from them. Clauses without parents are the inputs.
+struct SaturationImage
+{
+    std::vector<Formula*>      clauses;
+    std::vector<ClauseParents> parents;
+    std::vector<bool>          supported;
+    std::vector<int>           active;
+    int                        picks   = 0;
+    bool                       dropped = false;
+};
+
+// Clause store of the given clause loop. It can outlive one search, so a
+// caller may add clauses to a saturated set and continue from there.
+// Input clauses are borrowed, derived clauses are owned by the state.
+class SaturationState
+{
+private:
+    // first, the containers below book into it until they are gone
+    MemoryAccount memory;
+
+    template <typename T>
+    using Accounted = AccountedAllocator<T>;
+
+    using IndexKey  = std::pair<std::string, bool>;
+    using Positions = std::vector<int, Accounted<int>>;
+
+    std::vector<Formula*>      clauses;
+    std::vector<ClauseParents> parents;
+    std::vector<bool>          supported;
+    std::vector<int>           weights;
+    std::vector<int>           active;
+
+    // (predicate, negated) -> positions in active of the clauses with such a literal
+    std::map<IndexKey, Positions, std::less<IndexKey>,
+             std::scoped_allocator_adaptor<Accounted<std::pair<const IndexKey, Positions>>>> index;
+
+    // passive clauses ordered by age (ids grow with age) and by weight
+    std::set<int, std::less<int>, Accounted<int>>                                     passive_by_age;
+    std::set<std::pair<int, int>, std::less<std::pair<int, int>>, Accounted<std::pair<int, int>>> passive_by_weight;
+
+    size_t logged      = 0; // clauses written to a proof log by Run
+    int    picks       = 0;
+    int    refutation  = -1;
+    bool   has_support = false;
+    bool   dropped     = false;
+
+    void AddPassive(int id);
+    void Activate(int id);
+    void Candidates(int given, std::vector<int> &positions);
+    void AccountArrays();
+    void ExtractHistory(int root, std::vector<ResolutionStepInfo> &history);
+
+public:
+    SaturationState();
+    ~SaturationState();
+
+    SaturationState(const SaturationState&) = delete;
+    SaturationState &operator=(const SaturationState&) = delete;
+
+    // returns the id of the clause, supported clauses form the set of support
+    int AddInput(Formula *f, bool supported);
+
+    // Runs the given clause loop until a refutation, saturation or a limit.
+    // Steps of a refutation are appended to history.
+    ProofResult Run(const ResolutionOptions &options, std::vector<ResolutionStepInfo> &history);
+
+    // Checkpoints taken after the restored one become invalid. Input clauses
+    // past the checkpoint are dropped but not deleted, they are borrowed.
+    SaturationCheckpoint Checkpoint() const;
+    void Restore(const SaturationCheckpoint &checkpoint);
+
+    // Export shares the clauses with the state. Import fills an empty state
+    // and takes the derived clauses of the image over.
+    void Export(SaturationImage &image) const;
+    void Import(const SaturationImage &image);
+
+    size_t Size() const { return clauses.size(); }
+    size_t ActiveCount() const { return active.size(); }
+    const std::vector<Formula*> &Clauses() const { return clauses; }
+
+    // what the clauses, the arrays and the index take now and took at most,
+    // the history being the steps the last Run appended
+    const MemoryAccount &Memory() const { return memory; }
 };
 
 // PNF
 std::string FormulaAsString(Formula *f);
+std::string GetFormulaTypeStr(FormulaType type);
 Formula*    CloneFormula(Formula *f);
 void        DeleteFormula(Formula *f);
+size_t      FormulaBytes(Formula *f); // the nodes as allocated, with child arrays and names
+
+struct FormulaDeleter
+{
+    void operator()(Formula *f) const { DeleteFormula(f); }
+};
+
+// owns a formula until it is handed on, a parser linking it into a parent
+using FormulaPtr = std::unique_ptr<Formula, FormulaDeleter>;
 
 // PNF
 void MakePrenexNormalForm(Formula *f);
 
-// SNF
-void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem_counter);
+// SNF. With a symbol table the Skolem symbols are $a, $a1, ... for
+// constants and $n, ... for functions: names the parsers reject, so a
+// formula added later cannot reuse them.
+void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem_counter,
+               SymbolTable *symbols = nullptr);
 void DropUniversalQuantifiers(Formula *f);
 void MakeSkolemNormalForm(Formula *f);
+void MakeSkolemNormalForm(Formula *f, SymbolTable &symbols);
 
 // CNF
 void NormalizeFormula(Formula* f);
@@ -73,7 +441,22 @@ Formula *FindResolver(Formula *f1, Formula *f2);
 void     RemoveResolver(Formula *f, Formula *resolver);
 Formula *ResolutionStep(Formula *f1, Formula *f2, Formula *resolver);
 bool     IsTautology(Formula *f);
+void     ClauseLiterals(Formula *f, std::vector<Formula*> &literals);
+Formula *LiteralAtom(Formula *literal);
+bool     Subsumes(Formula *f1, Formula *f2);
+int      TermDepth(Formula *f);
+Formula *MaximalLiteral(Formula *f);
+Formula *MakeResolvent(Formula *f1, Formula *f2, bool ordered = false, bool *unified = nullptr);
+void     DeleteHistory(std::vector<ResolutionStepInfo> &history);
+void     ExtractProof(std::vector<Formula*> &clauses, std::vector<ClauseParents> &parents, int root,
+                      std::vector<ResolutionStepInfo> &history);
 bool     MakeResolution(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history);
+ProofResult MakeResolution(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history, const ResolutionOptions &options);
+
+// Portfolio
+std::vector<ResolutionOptions> PortfolioStrategies(int count, const ResolutionOptions &base = ResolutionOptions());
+ProofResult MakeResolutionPortfolio(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history, int threads,
+                                    const ResolutionOptions &options = ResolutionOptions());
 
 } // namespace rzlogic
 
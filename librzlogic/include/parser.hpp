@@ -2,37 +2,94 @@
 #define PARSER_HPP
 
 #include "logic.hpp"
+#include "tokenizer.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace rzlogic {
 
+class MappedFile;
+
 class Parser
 {
 private:
     std::string input;
-    char *cur_char;
-
-    enum class TokenType
-    {
-        LPAREN,
-        RPAREN,
-        IDENTIFIER,
-        END
-    };
-
-    std::string token_str;
-    TokenType   token_type;
+    Tokenizer   tokenizer;
+    Token       token;
 
     void        ParseToken();
     Formula*    ParseFormula();
     Formula*    ParseTerm();
     
 public:
-    Parser(const std::string &s) : input(s), cur_char((char*)input.c_str()) {}
+    Parser(const std::string &s) : input(s), tokenizer(input.data(), input.size()) {}
+    Parser(const Parser&) = delete;
+    Parser &operator=(const Parser&) = delete;
     Formula *Parse();
 };
 
 void ReadFormula(const char *str);
 
+// Parses a whole file of premises in the syntax of Parser: any number of
+// formulas separated by white space, # starts a comment up to the end of
+// the line. Works on a memory mapping of the file, tokens are views into
+// it and a name is only copied into the formula node it ends up in.
+// Both parsers read their tokens from a Tokenizer.
+// Predicate, function and constant names are interned into Symbols() as
+// they are met, so clausifying needs no second walk to collect them.
+// Errors throw std::runtime_error with the line and the column.
+class StreamParser
+{
+private:
+    std::unique_ptr<MappedFile> file;
+    std::string                 name;
+    size_t                      size;
+    Tokenizer                   tokenizer;
+    Token                       token;
+
+    // names met so far as views into the input, open addressing over
+    // their hashes. They go into the SymbolTable, whose set is slow to
+    // fill, only when it is asked for.
+    struct InternSlot
+    {
+        uint32_t hash = 0;
+        uint32_t name = 0; // index in names + 1, 0 for a free slot
+    };
+
+    std::vector<InternSlot>       interned;
+    std::vector<std::string_view> names;       // in the order they were met
+    SymbolTable                   symbols;
+    size_t                        names_in_table = 0;
+
+    void     ParseToken();
+    Formula *ParseFormula();
+    Formula *ParseTerm();
+    void     ResizeInterned(size_t slots);
+    bool     Intern(std::string_view name);
+    Formula *Symbol(FormulaType type);
+    [[noreturn]] void Error(const std::string &message) const;
+
+public:
+    explicit StreamParser(const std::string &path);
+
+    // data must outlive the parser, name is the file name of errors
+    StreamParser(const char *data, size_t size, const std::string &name = "<input>");
+    ~StreamParser();
+
+    StreamParser(const StreamParser&) = delete;
+    StreamParser &operator=(const StreamParser&) = delete;
+
+    // Calls consumer with every formula in file order, the consumer takes
+    // the formula over.
+    void Parse(const std::function<void(Formula*)> &consumer);
+
+    // the names of the formulas parsed so far
+    SymbolTable &Symbols();
+};
+
 } // namespace rzlogic
 
 #endif
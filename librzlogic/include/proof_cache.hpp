@@ -0,0 +1,95 @@
+#ifndef PROOF_CACHE_HPP
+#define PROOF_CACHE_HPP
+
+#include "prover.hpp"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rzlogic {
+
+struct CachedProof
+{
+    ProofResult                   result = ProofResult::UNKNOWN;
+    std::vector<ProofStepStrings> proof;  // variables numbered, see ProblemVariables
+};
+
+// Text of a clause set that does not depend on the names of the variables
+// or on the order of the clauses: variables are numbered by their first
+// occurrence in every clause and the clauses are sorted.
+std::string CanonicalProblemKey(const std::vector<Formula*> &clauses);
+
+// The variables of a problem numbered across all of its clauses, taken in
+// the order of CanonicalProblemKey. Problems with the same key can still
+// share variables between clauses differently, pattern tells them apart
+// and goes into the cache key too. Cached steps name variable i as _i.
+struct ProblemVariables
+{
+    std::vector<std::string> names;             // by number
+    std::string              pattern;           // "variables 0 1;2\n"
+    bool                     renamable = true;  // no other symbol looks like _i
+};
+
+// Appends the variables of clauses, the server adds premises and goals.
+void NumberProblemVariables(const std::vector<Formula*> &clauses, ProblemVariables &variables);
+
+// Steps of history with the variables numbered, false when a step has a
+// variable the problem does not have.
+bool CanonicalProofSteps(const std::vector<ResolutionStepInfo> &history, const ProblemVariables &variables,
+                         std::vector<ProofStepStrings> &steps);
+
+// Cached steps with the variables of the problem.
+std::vector<ProofStepStrings> RenameProofSteps(const std::vector<ProofStepStrings> &steps,
+                                               const ProblemVariables &variables);
+
+// 64-bit FNV-1a
+uint64_t HashProblemKey(const std::string &key);
+
+// Outcomes of finished proofs by problem key. The memory tier keeps the
+// most recently used entries, the optional disk tier keeps one file per
+// key in directory and survives the process. Safe to share between threads.
+class ProofCache
+{
+private:
+    struct Entry
+    {
+        std::string key;
+        CachedProof proof;
+    };
+
+    size_t      capacity;
+    std::string directory;
+
+    std::mutex       mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> by_key;
+
+    size_t hits   = 0;
+    size_t misses = 0;
+
+    void Remember(const std::string &key, const CachedProof &proof);
+    std::string EntryPath(const std::string &key) const;
+    bool LoadEntry(const std::string &key, CachedProof &proof) const;
+    void SaveEntry(const std::string &key, const CachedProof &proof) const;
+
+public:
+    explicit ProofCache(size_t capacity = 1024, const std::string &directory = "");
+
+    bool Lookup(const std::string &key, CachedProof &proof);
+
+    // Only PROVED and SATURATED are stored, UNKNOWN depends on the limits.
+    void Store(const std::string &key, const CachedProof &proof);
+
+    void Clear(); // the memory tier only
+
+    size_t Size();
+    size_t Hits();
+    size_t Misses();
+};
+
+} // namespace rzlogic
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef PROOF_LOG_HPP
+#define PROOF_LOG_HPP
+
+#include "logic.hpp"
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace rzlogic {
+
+enum class ProofLogFormat
+{
+    TSTP,   // cnf(...) lines readable by TPTP tools
+    BINARY  // varint encoded records with an inline symbol table
+};
+
+enum class InferenceRule : unsigned char
+{
+    INPUT,
+    RESOLUTION
+};
+
+struct ProofLogRecord
+{
+    int           id;
+    int           parent1;
+    int           parent2;
+    InferenceRule rule;
+    Formula      *clause;
+};
+
+// Append-only sink for inferences. Records are buffered and written as they
+// come, so nothing but the buffer and the symbol table stays in memory.
+class ProofLog
+{
+private:
+    FILE          *file;
+    std::string    path;
+    ProofLogFormat format;
+    std::string    buffer;
+    size_t         buffer_size;
+    std::mutex     mutex;
+
+    std::map<std::string, int> symbols; // binary mode only
+
+    void WriteTstp(int id, int parent1, int parent2, InferenceRule rule, Formula *clause);
+    void WriteBinary(int id, int parent1, int parent2, InferenceRule rule, Formula *clause);
+    void DefineSymbols(Formula *f);
+    void WriteTerm(Formula *f);
+    void WriteSymbol(const std::string &name);
+    void WriteVarint(unsigned long long value);
+    void WriteBuffer();
+
+public:
+    ProofLog(const std::string &path, ProofLogFormat format = ProofLogFormat::TSTP, size_t buffer_size = 1 << 16);
+    ~ProofLog();
+
+    ProofLog(const ProofLog&) = delete;
+    ProofLog &operator=(const ProofLog&) = delete;
+
+    // parents are -1 for input clauses. Both throw std::runtime_error when
+    // the file cannot be written, e.g. on a full disk; the destructor cannot,
+    // so a caller that needs to know flushes first.
+    void Append(int id, int parent1, int parent2, InferenceRule rule, Formula *clause);
+    void Flush();
+};
+
+std::string ClauseAsTstp(Formula *f);
+
+// Calls func for every record of a binary log. The clause is owned by the
+// reader and deleted after func returns. A truncated or corrupted log
+// throws std::runtime_error with the offset of the bad record.
+void ReadProofLog(const std::string &path, const std::function<void(const ProofLogRecord&)> &func);
+
+} // namespace rzlogic
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef PROVER_HPP
+#define PROVER_HPP
+
+#include "logic.hpp"
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace rzlogic {
+
+class ThreadPool;
+
+// (premise1, premise2, resolvent) as FormulaAsString renders them
+using ProofStepStrings = std::tuple<std::string, std::string, std::string>;
+
+struct BatchResult
+{
+    ProofResult                   result = ProofResult::UNKNOWN;
+    std::vector<ProofStepStrings> proof;
+    std::string                   error;  // set when the premises could not be parsed
+    ProofStatistics               statistics; // filled when options.statistics is set
+};
+
+// Parse -> Normalize -> PNF -> SNF -> CNF -> split, appending the clauses.
+// Nothing is appended when a premise fails to parse, the error is the one
+// of the first premise that fails. Skolem symbols start with $, which no
+// premise can contain, and are made against the symbols of all premises,
+// so they clash neither with the names of the problem nor with each other.
+//
+// With a pool the premises go through every stage but Skolemization in
+// parallel. The clauses and their symbols are the same as without one.
+// Not to be called from a task of pool, it waits for the pool.
+//
+// The time and the terms of every stage are added to statistics, if given.
+void ClausifyPremises(const std::vector<std::string> &premises, std::vector<Formula*> &clauses,
+                      ThreadPool *pool = nullptr, ProofStatistics *statistics = nullptr);
+
+// The same for parsed formulas, which are taken over and cleared.
+void ClausifyFormulas(std::vector<Formula*> &formulas, std::vector<Formula*> &clauses, ThreadPool *pool = nullptr,
+                      ProofStatistics *statistics = nullptr);
+
+// Parses a premise file with StreamParser and clausifies it. Nothing is
+// appended when the file fails to parse.
+void ClausifyPremiseFile(const std::string &path, std::vector<Formula*> &clauses, ThreadPool *pool = nullptr,
+                         ProofStatistics *statistics = nullptr);
+
+// Proves independent problems on a pool of threads, results come in input
+// order. Every problem runs single-threaded with the limits and the token
+// of options; options.poll is called on the calling thread while waiting.
+// options.progress is not used. With options.statistics every result gets
+// the statistics of its problem and the sums are added to options.statistics.
+void MakeResolutionBatch(const std::vector<std::vector<std::string>> &problems, std::vector<BatchResult> &results,
+                         int threads, const ResolutionOptions &options = ResolutionOptions());
+
+// A refutation as a DAG. Clauses are numbered 0 .. Size() - 1 in the order
+// they were derived, premises have -1 for parents.
+class ProofDag
+{
+private:
+    std::vector<Formula*> clauses;
+    std::vector<int32_t>  parents;    // parent1, parent2 of every clause
+    std::vector<int32_t>  search_ids; // ids the clauses had in the search
+
+public:
+    // Takes the formulas of the steps over, history is left empty.
+    explicit ProofDag(std::vector<ResolutionStepInfo> &history);
+
+    // Takes the clauses over, parents and search_ids as the accessors
+    // return them.
+    ProofDag(std::vector<Formula*> clauses, std::vector<int32_t> parents, std::vector<int32_t> search_ids);
+    ~ProofDag();
+
+    ProofDag(const ProofDag&) = delete;
+    ProofDag &operator=(const ProofDag&) = delete;
+
+    size_t   Size() const { return clauses.size(); }
+    Formula *Clause(size_t i) const { return clauses[i]; }
+    int      Parent1(size_t i) const { return parents[2 * i]; }
+    int      Parent2(size_t i) const { return parents[2 * i + 1]; }
+    int      SearchId(size_t i) const { return search_ids[i]; }
+
+    // Size() rows of (parent1, parent2)
+    const int32_t *ParentData() const { return parents.data(); }
+};
+
+struct TheorySnapshot;
+
+struct SessionCheckpoint
+{
+    size_t               clauses = 0;
+    size_t               fed     = 0;
+    SaturationCheckpoint state;
+};
+
+// Owns everything a proof needs: the clauses, the symbol table Skolem
+// symbols are made against and the clause store with its literal index.
+// A session is used by one thread at a time. Sessions share no state, so
+// any number of them can prove in parallel.
+//
+// Proving is incremental: the clause store survives between Prove calls,
+// clauses added since the last call join it as passive clauses and the
+// search goes on from where it stopped. Nothing is normalized or resolved
+// twice. Restore retracts everything added after a checkpoint.
+class ProverSession
+{
+private:
+    SymbolTable                      symbols;
+    std::vector<Formula*>            clauses;
+    std::vector<bool>                goal_clauses;
+    SaturationState                  state;
+    size_t                           fed = 0; // clauses already given to state
+    std::vector<ResolutionStepInfo>  proof;
+
+    void AddFormula(const std::string &formula, bool goal);
+    void MakeSnapshot(TheorySnapshot &snapshot, bool saturation) const;
+    void TakeSnapshot(TheorySnapshot &snapshot);
+
+public:
+    ProverSession() {}
+    ~ProverSession();
+
+    ProverSession(const ProverSession&) = delete;
+    ProverSession &operator=(const ProverSession&) = delete;
+
+    // The formula is clausified right away, a parse error throws
+    // std::runtime_error and leaves the session untouched.
+    void AddPremise(const std::string &formula);
+
+    // The negated goal is added, its clauses form the set of support.
+    void AddGoal(const std::string &formula);
+
+    // Searches with the set of support strategy whenever there are goals.
+    // Limits apply to this call only, a search that ran out of them can be
+    // resumed by calling Prove again.
+    ProofResult Prove(const ResolutionLimits &limits = ResolutionLimits());
+    ProofResult Prove(const ResolutionOptions &options);
+
+    // Restoring removes the premises and goals added after the checkpoint
+    // together with everything derived from them since. Checkpoints taken
+    // after the restored one become invalid.
+    SessionCheckpoint Checkpoint() const;
+    void Restore(const SessionCheckpoint &checkpoint);
+
+    // steps of the last refutation, empty unless Prove returned PROVED
+    const std::vector<ResolutionStepInfo> &Proof() const { return proof; }
+
+    // Writes the symbols and the clauses, with saturation also the derived
+    // clauses, so a loaded session goes on without redoing the search.
+    void SaveSnapshot(const std::string &path, bool saturation = true) const;
+
+    // Fills an empty session from a snapshot, no formula is parsed again.
+    void LoadSnapshot(const std::string &path);
+
+    // The snapshot as a buffer, to hand a session to another process
+    std::string Serialize(bool saturation = true) const;
+    void Deserialize(const char *data, size_t size);
+
+    // input clauses in the order they were added
+    const std::vector<Formula*> &Clauses() const { return clauses; }
+
+    // per input clause, true for the clauses of negated goals
+    const std::vector<bool> &GoalClauses() const { return goal_clauses; }
+
+    // Bytes of the clauses given to the search, its index and the current
+    // proof, live and at the peak. Limits.max_memory applies to the total.
+    const MemoryAccount &Memory() const { return state.Memory(); }
+};
+
+} // namespace rzlogic
+
+#endif
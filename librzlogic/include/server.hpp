@@ -0,0 +1,132 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "logic.hpp"
+#include "proof_cache.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rzlogic {
+
+// Messages on the socket are frames: a 4-byte little-endian length and
+// that many bytes. Requests are lines, the first one names the command:
+//
+//   prove                   ok proved|saturated|unknown
+//   theory NAME             step PREMISE1 \t PREMISE2 \t RESOLVENT
+//   premise FORMULA         ...
+//   goal FORMULA
+//   timeout SECONDS
+//   max_clauses N
+//   max_memory BYTES
+//   max_term_depth N
+//
+//   load NAME               ok
+//   premise FORMULA         (or snapshot PATH, a file of SaveSnapshot)
+//   goal FORMULA
+//   saturate                runs the theory with the limits given
+//
+//   drop NAME               ok
+//   stats                   ok, then "name value" lines
+//
+// A failed request is answered with "error MESSAGE".
+bool ReadFrame(int fd, std::string &payload);
+bool WriteFrame(int fd, const std::string &payload);
+
+struct ServerOptions
+{
+    std::string socket_path;
+    size_t      threads        = 0;    // 0 - one per core
+    size_t      cache_capacity = 4096;
+    std::string cache_directory;       // "" - memory only
+
+    // caps the search of every prove and saturating load, 0 - unlimited
+    double max_seconds = 0;
+};
+
+// Proves requests of local clients on a pool of threads. Loaded theories
+// are kept clausified, and with saturate also saturated, so a request
+// against a theory only adds its own formulas to a copy. Results are
+// cached by problem.
+//
+// Every connection has at most one request in flight and requests start
+// in the order they came, so no client holds the pool for long. The pool
+// runs its own tasks in no particular order, so every task it gets takes
+// the oldest request from a queue of the server.
+class ProofServer
+{
+private:
+    ServerOptions options;
+    int           listen_fd = -1;
+
+    std::unique_ptr<ThreadPool> pool;
+    ProofCache                  cache;
+    CancellationToken           shutdown;
+
+    std::thread                   acceptor;
+    std::mutex                    mutex;
+    std::set<int>                 clients;
+    std::map<size_t, std::thread> connections;
+    std::vector<size_t>           finished;    // connections to join
+    bool                          stopped = false;
+
+    // serialized sessions by name
+    std::map<std::string, std::shared_ptr<const std::string>> theories;
+
+    std::atomic<size_t> requests{0};
+
+    std::mutex                             queue_mutex;
+    std::deque<std::packaged_task<void()>> queue;       // oldest first
+
+    void AcceptLoop();
+    void CapSeconds(double &seconds) const; // to options.max_seconds
+    void Serve(int fd, size_t id);
+    void RunOldest();
+    std::string Handle(const std::string &request);
+    std::string Prove(const std::vector<std::string> &lines);
+    std::string Load(const std::vector<std::string> &lines);
+    std::string Stats();
+
+public:
+    // Binds and listens, a stale socket file is replaced.
+    explicit ProofServer(const ServerOptions &options);
+    ~ProofServer();
+
+    ProofServer(const ProofServer&) = delete;
+    ProofServer &operator=(const ProofServer&) = delete;
+
+    void Start();
+
+    // Cancels the running proofs, closes every connection and waits for
+    // them. Called by the destructor.
+    void Stop();
+};
+
+// Blocking client for one connection.
+class ProofClient
+{
+private:
+    int fd = -1;
+
+public:
+    explicit ProofClient(const std::string &socket_path);
+    ~ProofClient();
+
+    ProofClient(const ProofClient&) = delete;
+    ProofClient &operator=(const ProofClient&) = delete;
+
+    // Sends a request and waits for the answer.
+    std::string Request(const std::string &request);
+};
+
+} // namespace rzlogic
+
+#endif
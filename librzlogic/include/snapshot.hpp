@@ -0,0 +1,63 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "logic.hpp"
+#include "prover.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rzlogic {
+
+// Read-only memory mapping of a whole file. Processes mapping the same
+// file share its pages.
+class MappedFile
+{
+private:
+    const char *data = nullptr;
+    size_t      size = 0;
+
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    const char *Data() const { return data; }
+    size_t      Size() const { return size; }
+};
+
+// A clausified theory. The clauses are stored as trees, so loading skips
+// the parser and every normalization step.
+struct TheorySnapshot
+{
+    std::vector<std::string> symbols;  // the SymbolTable of the theory
+    std::vector<Formula*>    clauses;  // input clauses
+    std::vector<bool>        goals;    // per input clause
+
+    // the first saturated_inputs clauses were given to the saturation
+    bool            has_saturation   = false;
+    size_t          saturated_inputs = 0;
+    SaturationImage saturation;
+};
+
+// The clauses stay owned by the caller.
+void WriteSnapshot(const std::string &path, const TheorySnapshot &snapshot);
+
+// The clauses of snapshot are new, the inputs of snapshot.saturation are
+// the same objects as the first saturated_inputs of snapshot.clauses.
+void ReadSnapshot(const std::string &path, TheorySnapshot &snapshot);
+
+// The same format in memory. Deserializing decodes straight from data, a
+// malformed buffer throws std::runtime_error and leaves snapshot empty.
+std::string SerializeSnapshot(const TheorySnapshot &snapshot);
+void DeserializeSnapshot(const char *data, size_t size, TheorySnapshot &snapshot);
+
+// A ProofDag with its clauses and search ids, in the snapshot encoding
+std::string SerializeProof(const ProofDag &proof);
+std::unique_ptr<ProofDag> DeserializeProof(const char *data, size_t size);
+
+} // namespace rzlogic
+
+#endif
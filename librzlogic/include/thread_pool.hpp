@@ -0,0 +1,63 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rzlogic {
+
+// Work-stealing pool: every worker owns a deque, pops its own tasks from the
+// back and steals from the front of the other deques when it runs dry.
+class ThreadPool
+{
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex              wake_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t>     pending{0};
+    std::atomic<size_t>     next_queue{0};
+    bool                    stopping = false;
+
+    // tasks must not throw, Submit and ParallelFor catch for them
+    void Enqueue(std::function<void()> task);
+    void Push(size_t queue_idx, std::function<void()> task);
+    bool TryRunTask(size_t queue_idx);
+    void WorkerLoop(size_t queue_idx);
+
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool &operator=(const ThreadPool&) = delete;
+
+    size_t Size() const { return workers.size(); }
+
+    // Runs task on the pool. What it throws is stored in the future, a
+    // caller that does not wait for it loses the exception.
+    std::future<void> Submit(std::function<void()> task);
+
+    // Runs func(0) ... func(count - 1) on the pool and blocks until all of
+    // them are done. The calling thread takes part in the work, so it is safe
+    // to call from inside a pool task. The first exception thrown is rethrown.
+    void ParallelFor(size_t count, const std::function<void(size_t)> &func);
+};
+
+} // namespace rzlogic
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef TOKENIZER_HPP
+#define TOKENIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace rzlogic {
+
+enum class TokenType : uint8_t
+{
+    LPAREN,
+    RPAREN,
+    IDENTIFIER, // a run of letters and digits
+    INVALID,    // a single character that starts no token
+    END
+};
+
+struct Token
+{
+    std::string_view text; // a view into the input, empty for END
+    TokenType        type;
+};
+
+// The instruction sets the input can be classified with
+enum class ScanKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// the widest kernel the CPU runs, found once
+ScanKernel BestScanKernel();
+const char *ScanKernelName(ScanKernel kernel);
+
+// Splits S-expression text into parentheses and identifiers, any isspace
+// character separates them. The input is classified 64 bytes at a time
+// into bit masks (16 or 32 bytes per instruction with SSE2 or AVX2) and
+// tokens are cut from the mask bits, so white space and identifiers cost
+// nothing per byte past the classification.
+//
+// Tokens are made a batch at a time, the whole input never has a token
+// array. With comments, # starts a comment up to the end of the line.
+class Tokenizer
+{
+private:
+    const char *data;
+    size_t      size;
+    bool        comments;
+    ScanKernel  kernel;
+
+    size_t      pos = 0;             // the next block
+    uint64_t    carry = 0;           // the last byte of the previous block is in an identifier
+    const char *open = nullptr;      // start of the identifier not ended yet
+    size_t      skip_until = 0;      // the bytes before are in a comment
+
+    std::vector<Token> batch;
+    size_t             index = 0;
+
+    void ScanBlock();
+    void Fill();
+
+public:
+    Tokenizer(const char *data, size_t size, bool comments = false, ScanKernel kernel = BestScanKernel());
+
+    // END once the input is used up, and again on every call after
+    const Token &Next()
+    {
+        if (index == batch.size()) Fill();
+        return batch[index++];
+    }
+
+    const char *Data() const { return data; }
+};
+
+} // namespace rzlogic
+
+#endif
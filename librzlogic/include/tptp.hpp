@@ -0,0 +1,100 @@
+#ifndef TPTP_HPP
+#define TPTP_HPP
+
+#include "logic.hpp"
+#include <istream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rzlogic {
+
+// An annotated formula, cnf(name, role, formula). or fof(name, role, formula).
+// Variables are the TPTP ones, the free variables of a cnf clause stay free
+// like the ones of a clause of the pipeline.
+struct TptpFormula
+{
+    std::string name;
+    std::string role;              // axiom, hypothesis, conjecture, negated_conjecture ...
+    Formula    *formula = nullptr; // owned by the caller
+};
+
+// Reads the cnf and fof statements of a TPTP file one at a time, the file
+// is never held whole. include('file'). and include('file', [names]). are
+// followed, the file is looked up in include_dir first (the TPTP root) and
+// then next to the including file.
+//
+// <=> and <~> expand into implications, = and != are plain predicates as
+// there is no equality reasoning. tff and thf statements and $true and
+// $false are not supported. Errors throw std::runtime_error with the file
+// and the line.
+class TptpReader
+{
+private:
+    struct Source
+    {
+        std::unique_ptr<std::istream> file;
+        std::istream                 *in = nullptr;
+        std::string                   name;
+        std::string                   directory;
+        int                           line = 1;
+        std::set<std::string>         selection; // names to read, empty for all
+    };
+
+    enum class TokenType
+    {
+        LPAREN,
+        RPAREN,
+        LBRACKET,
+        RBRACKET,
+        COMMA,
+        DOT,
+        COLON,
+        OPERATOR,   // ~ & | => <= <=> <~> ~| ~& = != ! ?
+        LOWER_WORD, // functors and predicates, 'quoted' ones too
+        UPPER_WORD, // variables
+        DOLLAR_WORD,
+        NUMBER,
+        DISTINCT,   // "distinct object"
+        END
+    };
+
+    std::vector<Source> sources;
+    std::string         include_dir;
+
+    std::string token_str;
+    TokenType   token_type;
+
+    void OpenFile(const std::string &path, const std::set<std::string> &selection);
+    void ParseToken();
+    void Expect(TokenType type, const char *what);
+    void Include();
+    void SkipAnnotations();
+    [[noreturn]] void Error(const std::string &message) const;
+
+    Formula *ParseFormula();
+    Formula *ParseUnitary();
+    Formula *ParseAtom();
+    Formula *ParseTerm();
+
+public:
+    explicit TptpReader(const std::string &path, const std::string &include_dir = "");
+
+    // in must outlive the reader, name is the file name of errors
+    TptpReader(std::istream &in, const std::string &name, const std::string &include_dir = "");
+
+    TptpReader(const TptpReader&) = delete;
+    TptpReader &operator=(const TptpReader&) = delete;
+
+    // false once the input and everything it includes is read
+    bool Next(TptpFormula &formula);
+};
+
+// The formulas of a problem as premises of a refutation, conjectures are
+// negated. Nothing is appended when the problem cannot be read.
+void ReadTptpProblem(const std::string &path, std::vector<Formula*> &premises, const std::string &include_dir = "");
+
+} // namespace rzlogic
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace rzlogic {
+
+// Timeline of the prover stages in the Chrome trace event format, for
+// chrome://tracing or ui.perfetto.dev. Events are recorded only in builds
+// configured with -DRZLOGIC_TRACING=ON; otherwise the macros below compile
+// to nothing and WriteTrace throws.
+//
+//     StartTracing();
+//     ... prove ...
+//     StopTracing();
+//     WriteTrace("proof.json");
+
+// false unless built with RZLOGIC_TRACING
+bool TracingAvailable();
+
+// Drops the events recorded so far and starts recording. No traced work
+// may be running, the buffers of its threads are reset.
+void StartTracing();
+void StopTracing();
+
+// Writes the events recorded since StartTracing. Events still being
+// recorded by running work may or may not be included.
+void WriteTrace(const std::string &path);
+
+#ifdef RZLOGIC_TRACING
+
+// names are string literals, only the pointer is kept
+struct TraceEvent
+{
+    const char *name;
+    int64_t     start;    // steady clock nanoseconds
+    int64_t     duration; // of a scope
+    int64_t     value;    // of a counter
+    char        phase;    // 'X' for a scope, 'C' for a counter
+};
+
+extern std::atomic<bool> trace_recording;
+
+int64_t TraceNow();
+
+// appends to the buffer of the calling thread, without locking
+void RecordTraceEvent(const TraceEvent &event);
+
+class TraceScope
+{
+private:
+    const char *name;
+    int64_t     start;
+
+public:
+    explicit TraceScope(const char *name)
+        : name(name), start(trace_recording.load(std::memory_order_relaxed) ? TraceNow() : -1) {}
+
+    ~TraceScope()
+    {
+        if (start >= 0) RecordTraceEvent({name, start, TraceNow() - start, 0, 'X'});
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope &operator=(const TraceScope&) = delete;
+};
+
+#define RZLOGIC_TRACE_CONCAT_(a, b) a##b
+#define RZLOGIC_TRACE_CONCAT(a, b) RZLOGIC_TRACE_CONCAT_(a, b)
+
+// a slice from here to the end of the enclosing block
+#define RZLOGIC_TRACE_SCOPE(name) ::rzlogic::TraceScope RZLOGIC_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+// a sample of a value drawn as a graph, value is not evaluated when disabled
+#define RZLOGIC_TRACE_COUNTER(name, value) \
+    do { \
+        if (::rzlogic::trace_recording.load(std::memory_order_relaxed)) { \
+            ::rzlogic::RecordTraceEvent({name, ::rzlogic::TraceNow(), 0, (int64_t)(value), 'C'}); \
+        } \
+    } while (0)
+
+#else
+
+#define RZLOGIC_TRACE_SCOPE(name) (void)(name)
+#define RZLOGIC_TRACE_COUNTER(name, value) do {} while (0)
+
+#endif
+
+} // namespace rzlogic
+
+#endif
@@ -1,46 +1,723 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include "generators.hpp"
 #include "logic.hpp"
 #include "parser.hpp"
+#include "proof_cache.hpp"
+#include "proof_log.hpp"
+#include "prover.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 
 using namespace rzlogic;
 namespace py = pybind11;
 
-using StepWrapper = std::tuple<std::string, std::string, std::string>;
+using StepWrapper = ProofStepStrings;
 
-std::tuple<bool, std::vector<StepWrapper>> MakeResolutionWrapper(const std::vector<std::string> &premises) 
+// everything a proof needs, filled in while holding the GIL
+struct ProofArgs
 {
+    std::vector<std::string> premises;
+    int                      portfolio = 0;
+    std::string              proof_log;
+    ProofLogFormat           proof_log_format = ProofLogFormat::TSTP;
+    ResolutionOptions        options;
+    std::shared_ptr<ProofCache> cache;
+    bool                     structured = false;
+
+    std::shared_ptr<py::object> progress;       // callable, released with the GIL
+    double                   progress_interval = 0.5;
+    std::exception_ptr       progress_error;    // raised by progress
+
+    bool                     statistics = false;
+};
+
+struct ProofOutcome
+{
+    ProofResult               result = ProofResult::UNKNOWN;
+    std::vector<StepWrapper>  history;
+    std::shared_ptr<ProofDag> dag;     // instead of history for structured proofs
+    std::shared_ptr<ProofStatistics> statistics; // when asked for
+};
+
+// Python views into a ProofDag. They keep the DAG alive and render strings
+// only when asked.
+struct ProofClause
+{
+    std::shared_ptr<ProofDag> dag;
+    size_t                    index;
+};
+
+struct ProofLiteral
+{
+    std::shared_ptr<ProofDag> dag;
+    Formula                  *literal;
+};
+
+// ProgressInfo with the units rendered, so it outlives the report
+struct ProgressBatch
+{
+    double                   seconds   = 0;
+    size_t                   generated = 0;
+    size_t                   kept      = 0;
+    size_t                   clauses   = 0;
+    size_t                   active    = 0;
+    size_t                   passive   = 0;
+    size_t                   memory    = 0;
+    std::vector<std::string> units;
+};
+
+ProgressBatch MakeProgressBatch(const ProgressInfo &info)
+{
+    ProgressBatch batch;
+    batch.seconds   = info.seconds;
+    batch.generated = info.generated;
+    batch.kept      = info.kept;
+    batch.clauses   = info.clauses;
+    batch.active    = info.active;
+    batch.passive   = info.passive;
+    batch.memory    = info.memory;
+    for (Formula *unit : info.units) batch.units.push_back(FormulaAsString(unit));
+    return batch;
+}
+
+ProofArgs MakeProofArgs(const std::vector<std::string> &premises,
+                        int threads, int portfolio,
+                        double timeout, size_t max_clauses,
+                        size_t max_memory, int max_term_depth,
+                        const CancellationToken *cancel,
+                        const std::string &proof_log,
+                        const std::string &proof_log_format,
+                        std::shared_ptr<ProofCache> cache,
+                        bool structured,
+                        py::object progress = py::none(),
+                        double progress_interval = 0.5,
+                        bool statistics = false)
+{
+    if (proof_log_format != "tstp" && proof_log_format != "binary")
+    {
+        throw py::value_error("proof_log_format must be 'tstp' or 'binary'");
+    }
+    if (!progress.is_none() && !PyCallable_Check(progress.ptr()))
+    {
+        throw py::type_error("progress must be callable");
+    }
+
+    ProofArgs args;
+    args.premises         = premises;
+    args.portfolio        = portfolio;
+    args.proof_log        = proof_log;
+    args.proof_log_format = (proof_log_format == "tstp") ? ProofLogFormat::TSTP : ProofLogFormat::BINARY;
+    args.cache            = cache;
+    args.structured       = structured;
+    args.statistics       = statistics;
+
+    // copies of the callback travel with the options to GIL-free threads,
+    // only the last one touches the reference count
+    if (!progress.is_none())
+    {
+        args.progress = std::shared_ptr<py::object>(new py::object(progress), [](py::object *callback)
+        {
+            py::gil_scoped_acquire acquire;
+            delete callback;
+        });
+        args.progress_interval = progress_interval;
+    }
+
+    ResolutionOptions &options = args.options;
+    options.threads               = threads;
+    options.limits.max_seconds    = timeout;
+    options.limits.max_generated  = max_clauses;
+    options.limits.max_memory     = max_memory;
+    options.limits.max_term_depth = max_term_depth;
+
+    // a child, so Ctrl+C does not cancel the caller's token
+    if (cancel) options.cancel = cancel->Child();
+
+    return args;
+}
+
+// Hands every report to the Python callback, holding the GIL only for the
+// call. Returning False or raising cancels the search; the exception is
+// kept in args and raised again once the search returns.
+void InstallProgress(ProofArgs &args)
+{
+    if (!args.progress) return;
+
+    args.options.progress_interval = args.progress_interval;
+    args.options.progress = [callback = args.progress, token = args.options.cancel,
+                             &error = args.progress_error](const ProgressInfo &info)
+    {
+        if (error) return;
+
+        ProgressBatch batch = MakeProgressBatch(info);
+
+        py::gil_scoped_acquire acquire;
+        try
+        {
+            py::object keep_going = (*callback)(batch);
+            if (keep_going.is(py::bool_(false))) token.Cancel();
+        }
+        catch (py::error_already_set &)
+        {
+            error = std::current_exception();
+            token.Cancel();
+        }
+    };
+}
+
+// The clauses and the proof of RunProof, freed however it returns or throws
+struct ProofClauses
+{
+    std::vector<Formula*>           formulas;
     std::vector<ResolutionStepInfo> history;
-    std::vector<Formula*> formuls;
-    std::vector<StepWrapper> history_out;
 
-    for (const auto &str: premises)
+    ProofClauses() = default;
+    ProofClauses(const ProofClauses&) = delete;
+    ProofClauses &operator=(const ProofClauses&) = delete;
+
+    ~ProofClauses()
+    {
+        DeleteHistory(history);
+        for (Formula *f : formulas) DeleteFormula(f);
+    }
+};
+
+// Parses, normalizes and proves. Touches no Python objects, so it runs
+// without the GIL; only a progress callback takes it, see InstallProgress.
+ProofOutcome RunProof(ProofArgs &args)
+{
+    InstallProgress(args);
+
+    std::unique_ptr<ProofLog> log;
+    if (!args.proof_log.empty())
+    {
+        log = std::make_unique<ProofLog>(args.proof_log, args.proof_log_format);
+        args.options.log = log.get();
+    }
+
+    ProofClauses clauses;
+    std::vector<ResolutionStepInfo> &history = clauses.history;
+    std::vector<Formula*> &formuls = clauses.formulas;
+    ProofOutcome outcome;
+
+    if (args.statistics)
     {
-        Formula *f = Parser(str).Parse();
+        outcome.statistics = std::make_shared<ProofStatistics>();
+        args.options.statistics = outcome.statistics.get();
+    }
+
+    // a large premise set takes longer to clausify than to prove, so the
+    // premises are clausified on threads too
+    {
+        std::unique_ptr<ThreadPool> pool;
+        if (args.options.threads > 1 && args.premises.size() > 1) {
+            pool = std::make_unique<ThreadPool>(args.options.threads);
+        }
+        ClausifyPremises(args.premises, formuls, pool.get(), outcome.statistics.get());
+    }
 
-        NormalizeFormula(f);
-        MakePrenexNormalForm(f);
-        MakeSkolemNormalForm(f);
-        MakeConjunctiveNormalForm(f);
-        SplitConjunctions(f, formuls);
+    // a hit has neither inferences to log nor clauses for a structured
+    // proof, so such proofs always search
+    std::string key;
+    ProblemVariables variables;
+    if (args.cache && !log && !args.structured)
+    {
+        NumberProblemVariables(formuls, variables);
+        if (variables.renamable)
+        {
+            key = CanonicalProblemKey(formuls) + variables.pattern;
+            if (args.portfolio > 1) key += "portfolio " + std::to_string(args.portfolio) + "\n";
+        }
+
+        CachedProof cached;
+        if (!key.empty() && args.cache->Lookup(key, cached))
+        {
+            outcome.result  = cached.result;
+            outcome.history = RenameProofSteps(cached.proof, variables);
+            return outcome;
+        }
     }
 
-    bool result = MakeResolution(formuls, history);
+    outcome.result = (args.portfolio > 1) ? MakeResolutionPortfolio(formuls, history, args.portfolio, args.options)
+                                          : MakeResolution(formuls, history, args.options);
+
+    // a full disk surfaces here rather than in the destructor
+    if (log) log->Flush();
     
+    if (args.structured)
+    {
+        outcome.dag = std::make_shared<ProofDag>(history);
+    }
+
     for (const auto& step : history) 
     {
         StepWrapper info = {FormulaAsString(step.premise1), 
                             FormulaAsString(step.premise2), 
                             FormulaAsString(step.resolvent)};
-        history_out.push_back(info);
+        outcome.history.push_back(info);
     }
 
-    for (Formula *f: formuls) DeleteFormula(f);
-    
-    return std::make_tuple(result, history_out);
+    // cached with numbered variables, a renamed problem gets its own names
+    CachedProof cached;
+    if (!key.empty() && CanonicalProofSteps(history, variables, cached.proof))
+    {
+        cached.result = outcome.result;
+        args.cache->Store(key, cached);
+    }
+
+    return outcome;
+}
+
+py::object ProofResultToPython(ProofResult result)
+{
+    switch (result) {
+    case ProofResult::PROVED:    return py::bool_(true);
+    case ProofResult::SATURATED: return py::bool_(false);
+    case ProofResult::UNKNOWN:   break;
+    }
+    return py::none();
+}
+
+py::tuple ProofOutcomeToPython(const ProofOutcome &outcome)
+{
+    py::object proof = outcome.dag ? py::cast(outcome.dag) : py::cast(outcome.history);
+
+    if (outcome.statistics) return py::make_tuple(ProofResultToPython(outcome.result), proof, py::cast(*outcome.statistics));
+
+    return py::make_tuple(ProofResultToPython(outcome.result), proof);
+}
+
+// Signals are only delivered with the GIL, so a search running without it
+// takes the GIL briefly now and then and turns Ctrl+C into a cancellation.
+std::function<void()> SignalPoll(bool &interrupted, const CancellationToken &token)
+{
+    auto last_poll = std::chrono::steady_clock::now();
+
+    return [&interrupted, last_poll, token]() mutable
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (interrupted || now - last_poll < std::chrono::milliseconds(50)) return;
+        last_poll = now;
+
+        py::gil_scoped_acquire acquire;
+        if (PyErr_CheckSignals() != 0)
+        {
+            interrupted = true;
+            token.Cancel();
+        }
+    };
+}
+
+py::tuple MakeResolutionWrapper(const std::vector<std::string> &premises,
+                                int threads, int portfolio,
+                                double timeout, size_t max_clauses,
+                                size_t max_memory, int max_term_depth,
+                                const CancellationToken *cancel,
+                                const std::string &proof_log,
+                                const std::string &proof_log_format,
+                                std::shared_ptr<ProofCache> cache,
+                                bool structured,
+                                py::object progress,
+                                double progress_interval,
+                                bool statistics)
+{
+    ProofArgs args = MakeProofArgs(premises, threads, portfolio, timeout, max_clauses, max_memory,
+                                   max_term_depth, cancel, proof_log, proof_log_format, cache, structured,
+                                   progress, progress_interval, statistics);
+
+    bool interrupted = false;
+    args.options.poll = SignalPoll(interrupted, args.options.cancel);
+
+    ProofOutcome outcome;
+    {
+        py::gil_scoped_release release;
+        outcome = RunProof(args);
+    }
+
+    // KeyboardInterrupt is already set by PyErr_CheckSignals
+    if (interrupted) throw py::error_already_set();
+    if (args.progress_error) std::rethrow_exception(args.progress_error);
+
+    return ProofOutcomeToPython(outcome);
+}
+
+py::list MakeResolutionBatchWrapper(const std::vector<std::vector<std::string>> &problems, int threads,
+                                    double timeout, size_t max_clauses,
+                                    size_t max_memory, int max_term_depth,
+                                    const CancellationToken *cancel)
+{
+    ProofArgs args = MakeProofArgs({}, 1, 0, timeout, max_clauses, max_memory, max_term_depth, cancel, "", "tstp", nullptr, false);
+
+    bool interrupted = false;
+    args.options.poll = SignalPoll(interrupted, args.options.cancel);
+
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<BatchResult> results;
+    {
+        py::gil_scoped_release release;
+        MakeResolutionBatch(problems, results, threads, args.options);
+    }
+
+    if (interrupted) throw py::error_already_set();
+
+    py::list out;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (!results[i].error.empty())
+        {
+            throw std::runtime_error("problem " + std::to_string(i) + ": " + results[i].error);
+        }
+        out.append(py::make_tuple(ProofResultToPython(results[i].result), py::cast(results[i].proof)));
+    }
+
+    return out;
+}
+
+// Pickled states are decoded in place, straight from the bytes object
+std::pair<const char*, size_t> BytesData(const py::bytes &state)
+{
+    char       *data;
+    py::ssize_t size;
+    if (PyBytes_AsStringAndSize(state.ptr(), &data, &size) != 0) throw py::error_already_set();
+    return {data, (size_t)size};
+}
+
+// A session must not be used by two threads at once, and prove releases
+// the GIL. Concurrent use raises instead of corrupting the session.
+struct PyProverSession
+{
+    ProverSession     session;
+    std::atomic<bool> busy{false};
+};
+
+class SessionUse
+{
+private:
+    std::atomic<bool> &busy;
+
+public:
+    SessionUse(PyProverSession &py_session) : busy(py_session.busy)
+    {
+        if (busy.exchange(true)) throw std::runtime_error("ProverSession is in use by another thread");
+    }
+    ~SessionUse() { busy = false; }
+};
+
+py::tuple SessionProveWrapper(PyProverSession &py_session, int threads,
+                              double timeout, size_t max_clauses,
+                              size_t max_memory, int max_term_depth,
+                              const CancellationToken *cancel, bool structured,
+                              py::object progress, double progress_interval)
+{
+    SessionUse use(py_session);
+
+    ProofArgs args = MakeProofArgs({}, threads, 0, timeout, max_clauses, max_memory, max_term_depth, cancel, "", "tstp",
+                                   nullptr, false, progress, progress_interval);
+
+    bool interrupted = false;
+    args.options.poll = SignalPoll(interrupted, args.options.cancel);
+    args.options.set_of_support = true;
+    InstallProgress(args);
+
+    ProofOutcome outcome;
+    {
+        py::gil_scoped_release release;
+        outcome.result = py_session.session.Prove(args.options);
+
+        if (!structured)
+        {
+            for (const ResolutionStepInfo &step : py_session.session.Proof())
+            {
+                outcome.history.emplace_back(FormulaAsString(step.premise1),
+                                             FormulaAsString(step.premise2),
+                                             FormulaAsString(step.resolvent));
+            }
+        }
+        else
+        {
+            // the session keeps its proof, the DAG gets copies
+            std::vector<ResolutionStepInfo> steps;
+            for (const ResolutionStepInfo &step : py_session.session.Proof())
+            {
+                ResolutionStepInfo copy = step;
+                copy.premise1  = CloneFormula(step.premise1);
+                copy.premise2  = CloneFormula(step.premise2);
+                copy.resolvent = CloneFormula(step.resolvent);
+                steps.push_back(copy);
+            }
+            outcome.dag = std::make_shared<ProofDag>(steps);
+        }
+    }
+
+    if (interrupted) throw py::error_already_set();
+    if (args.progress_error) std::rethrow_exception(args.progress_error);
+
+    return ProofOutcomeToPython(outcome);
+}
+
+// Proofs submitted from Python run here. Never destroyed: workers may still
+// hold Python objects while the interpreter shuts down.
+ThreadPool &AsyncPool()
+{
+    static ThreadPool *pool = new ThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+    return *pool;
 }
 
+// cancelled at interpreter exit, so pending proofs end quickly
+CancellationToken &AsyncShutdownToken()
+{
+    static CancellationToken *token = new CancellationToken();
+    return *token;
+}
+
+struct AsyncJob
+{
+    ProofArgs  args;
+    py::object future;
+};
+
+py::object SubmitWrapper(const std::vector<std::string> &premises,
+                         int threads, int portfolio,
+                         double timeout, size_t max_clauses,
+                         size_t max_memory, int max_term_depth,
+                         const CancellationToken *cancel,
+                         const std::string &proof_log,
+                         const std::string &proof_log_format,
+                         std::shared_ptr<ProofCache> cache,
+                         bool structured,
+                         py::object progress,
+                         double progress_interval,
+                         bool statistics)
+{
+    py::object future = py::module_::import("concurrent.futures").attr("Future")();
+    future.attr("set_running_or_notify_cancel")();
+
+    AsyncJob *job = new AsyncJob{MakeProofArgs(premises, threads, portfolio, timeout, max_clauses, max_memory,
+                                               max_term_depth, cancel, proof_log, proof_log_format, cache, structured,
+                                               progress, progress_interval, statistics),
+                                 future};
+
+    CancellationToken shutdown = AsyncShutdownToken();
+    if (!cancel) job->args.options.cancel = shutdown.Child();
+
+    AsyncPool().Submit([job, shutdown]
+    {
+        ProofOutcome outcome;
+        std::exception_ptr error;
+
+        // a job owning a caller's token still has to stop at exit
+        job->args.options.poll = [shutdown, token = job->args.options.cancel]()
+        {
+            if (shutdown.IsCancelled()) token.Cancel();
+        };
+
+        try {
+            outcome = RunProof(job->args);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        if (!error) error = job->args.progress_error;
+
+        py::gil_scoped_acquire acquire;
+        try
+        {
+            if (error)
+            {
+                try {
+                    std::rethrow_exception(error);
+                }
+                catch (py::error_already_set &e) {
+                    job->future.attr("set_exception")(e.value());
+                }
+                catch (const std::exception &e) {
+                    job->future.attr("set_exception")(py::module_::import("builtins").attr("RuntimeError")(e.what()));
+                }
+            }
+            else
+            {
+                job->future.attr("set_result")(ProofOutcomeToPython(outcome));
+            }
+        }
+        catch (py::error_already_set &e)
+        {
+            // nobody waits for the result any more
+            e.discard_as_unraisable(__func__);
+        }
+
+        delete job;
+    });
+
+    return future;
+}
+
+py::object MakeResolutionAsyncWrapper(const std::vector<std::string> &premises,
+                                      int threads, int portfolio,
+                                      double timeout, size_t max_clauses,
+                                      size_t max_memory, int max_term_depth,
+                                      const CancellationToken *cancel,
+                                      const std::string &proof_log,
+                                      const std::string &proof_log_format,
+                                      std::shared_ptr<ProofCache> cache,
+                                      bool structured,
+                                      py::object progress,
+                                      double progress_interval,
+                                      bool statistics)
+{
+    py::object future = SubmitWrapper(premises, threads, portfolio, timeout, max_clauses, max_memory,
+                                      max_term_depth, cancel, proof_log, proof_log_format, cache, structured,
+                                      progress, progress_interval, statistics);
+
+    return py::module_::import("asyncio").attr("wrap_future")(future);
+}
+
+// Reports of a proof running on the pool, shared by the job and the
+// iterator reading them
+struct ProgressStream
+{
+    std::mutex                mutex;
+    std::condition_variable   changed;
+    std::deque<ProgressBatch> batches;
+    bool                      done = false;
+    ProofOutcome              outcome;
+    std::string               error;
+    CancellationToken         token;
+};
+
+// Python iterator over the reports. Dropping it cancels the proof.
+class ProgressIterator
+{
+private:
+    std::shared_ptr<ProgressStream> stream;
+
+public:
+    explicit ProgressIterator(std::shared_ptr<ProgressStream> stream) : stream(stream) {}
+    ~ProgressIterator() { stream->token.Cancel(); }
+
+    ProgressIterator(const ProgressIterator&) = delete;
+    ProgressIterator &operator=(const ProgressIterator&) = delete;
+
+    ProgressBatch Next()
+    {
+        ProgressBatch batch;
+        bool          found = false;
+        std::string   error;
+
+        // the mutex is never held while taking the GIL back
+        {
+            py::gil_scoped_release release;
+            std::unique_lock<std::mutex> lock(stream->mutex);
+            stream->changed.wait(lock, [this] { return !stream->batches.empty() || stream->done; });
+
+            if (!stream->batches.empty())
+            {
+                batch = std::move(stream->batches.front());
+                stream->batches.pop_front();
+                found = true;
+            }
+            error = stream->error;
+        }
+
+        if (found) return batch;
+        if (!error.empty()) throw std::runtime_error(error);
+        throw py::stop_iteration();
+    }
+
+    py::object Result()
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (!stream->done) return py::none();
+        return ProofOutcomeToPython(stream->outcome);
+    }
+
+    void Cancel() { stream->token.Cancel(); }
+};
+
+std::unique_ptr<ProgressIterator> IterateResolutionWrapper(const std::vector<std::string> &premises,
+                                                           int threads, int portfolio,
+                                                           double timeout, size_t max_clauses,
+                                                           size_t max_memory, int max_term_depth,
+                                                           const CancellationToken *cancel,
+                                                           std::shared_ptr<ProofCache> cache,
+                                                           bool structured,
+                                                           double progress_interval)
+{
+    auto stream = std::make_shared<ProgressStream>();
+    auto args = std::make_shared<ProofArgs>(MakeProofArgs(premises, threads, portfolio, timeout, max_clauses, max_memory,
+                                                          max_term_depth, cancel, "", "tstp", cache, structured));
+
+    CancellationToken shutdown = AsyncShutdownToken();
+    if (!cancel) args->options.cancel = shutdown.Child();
+    stream->token = args->options.cancel;
+
+    // the reports are rendered on the proving thread and queued, the GIL
+    // is never needed there
+    args->options.progress_interval = progress_interval;
+    args->options.progress = [stream](const ProgressInfo &info)
+    {
+        ProgressBatch batch = MakeProgressBatch(info);
+
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->batches.push_back(std::move(batch));
+        stream->changed.notify_all();
+    };
+    args->options.poll = [shutdown, token = args->options.cancel]()
+    {
+        if (shutdown.IsCancelled()) token.Cancel();
+    };
+
+    AsyncPool().Submit([args, stream]
+    {
+        ProofOutcome outcome;
+        std::string error;
+
+        try {
+            outcome = RunProof(*args);
+        }
+        catch (const std::exception &e) {
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->outcome = std::move(outcome);
+        stream->error   = error;
+        stream->done    = true;
+        stream->changed.notify_all();
+    });
+
+    return std::make_unique<ProgressIterator>(stream);
+}
+
+// keyword arguments shared by make_resolution, submit and make_resolution_async
+#define RZLOGIC_PROOF_ARGS \
+    py::arg("premises"), \
+    py::arg("threads") = 1, \
+    py::arg("portfolio") = 0, \
+    py::arg("timeout") = 0.0, \
+    py::arg("max_clauses") = 0, \
+    py::arg("max_memory") = 0, \
+    py::arg("max_term_depth") = 0, \
+    py::arg("cancel") = py::none(), \
+    py::arg("proof_log") = "", \
+    py::arg("proof_log_format") = "tstp", \
+    py::arg("cache") = py::none(), \
+    py::arg("structured") = false, \
+    py::arg("progress") = py::none(), \
+    py::arg("progress_interval") = 0.5, \
+    py::arg("statistics") = false
+
 PYBIND11_MODULE(rzlogic, rz)
 {
     rz.doc() = R"pbdoc(
@@ -58,9 +735,219 @@ PYBIND11_MODULE(rzlogic, rz)
         - Resolution proof procedure
         - Step-by-step proof history
     )pbdoc";
+
+    py::class_<CancellationToken>(rz, "CancellationToken", R"pbdoc(
+        Stops a running make_resolution call, which then returns None.
+        The token may be cancelled from any thread.
+    )pbdoc")
+        .def(py::init<>())
+        .def("cancel", &CancellationToken::Cancel, "Request cancellation of the proofs using this token.")
+        .def_property_readonly("cancelled", &CancellationToken::IsCancelled);
     
+    py::class_<ProofCache, std::shared_ptr<ProofCache>>(rz, "ProofCache", R"pbdoc(
+        Results of finished proofs for the cache argument of make_resolution.
+
+        Problems are keyed by their clauses with the variables numbered in
+        order and the clauses sorted. The most recently used entries are
+        kept in memory; with a directory every entry is also written to a
+        file there, so the cache survives the process and can be shared
+        between processes.
+
+        Example:
+            >>> cache = rzlogic.ProofCache(capacity=4096, directory="/var/cache/rzlogic")
+            >>> success, history = rzlogic.make_resolution(premises, cache=cache)
+    )pbdoc")
+        .def(py::init<size_t, const std::string&>(),
+             py::arg("capacity") = 1024,
+             py::arg("directory") = "")
+        .def("clear", &ProofCache::Clear, "Drop the entries kept in memory.")
+        .def_property_readonly("size", &ProofCache::Size)
+        .def_property_readonly("hits", &ProofCache::Hits)
+        .def_property_readonly("misses", &ProofCache::Misses);
+
+    py::class_<ProgressBatch>(rz, "Progress", R"pbdoc(
+        A progress report of a running proof, see the progress argument of
+        make_resolution and iterate_resolution.
+    )pbdoc")
+        .def_readonly("seconds", &ProgressBatch::seconds, "Wall time since the search started.")
+        .def_readonly("generated", &ProgressBatch::generated, "Resolvents generated so far.")
+        .def_readonly("kept", &ProgressBatch::kept, "Resolvents kept after the redundancy checks.")
+        .def_readonly("clauses", &ProgressBatch::clauses, "Size of the clause set.")
+        .def_readonly("active", &ProgressBatch::active)
+        .def_readonly("passive", &ProgressBatch::passive)
+        .def_readonly("memory", &ProgressBatch::memory, "Bytes held by the search, as max_memory counts them.")
+        .def_readonly("units", &ProgressBatch::units,
+            "Unit clauses derived since the previous report, the empty clause included.")
+        .def("__repr__", [](const ProgressBatch &self) {
+                return "<Progress " + std::to_string(self.generated) + " generated, " +
+                       std::to_string(self.clauses) + " clauses>";
+            });
+
+    py::class_<MemoryUsage>(rz, "MemoryUsage", R"pbdoc(
+        Bytes held by a search, by what holds them. max_memory budgets the
+        total.
+    )pbdoc")
+        .def_readonly("terms", &MemoryUsage::terms, "Formula nodes of the clauses with their child arrays and names.")
+        .def_readonly("clauses", &MemoryUsage::clauses, "Per clause arrays of the clause store.")
+        .def_readonly("index", &MemoryUsage::index, "Literal index and passive queues.")
+        .def_readonly("history", &MemoryUsage::history, "Proof steps of the last search.")
+        .def_property_readonly("total", &MemoryUsage::Total)
+        .def("__repr__", [](const MemoryUsage &self) {
+                return "<MemoryUsage " + std::to_string(self.Total()) + " bytes>";
+            });
+
+    py::class_<ProofStatistics>(rz, "Statistics", R"pbdoc(
+        What the stages of a proof did, see the statistics argument of
+        make_resolution. Stage times are summed over the threads working
+        on a stage.
+    )pbdoc")
+        .def_readonly("parse_seconds", &ProofStatistics::parse_seconds)
+        .def_readonly("normalize_seconds", &ProofStatistics::normalize_seconds)
+        .def_readonly("prenex_seconds", &ProofStatistics::prenex_seconds)
+        .def_readonly("skolem_seconds", &ProofStatistics::skolem_seconds)
+        .def_readonly("cnf_seconds", &ProofStatistics::cnf_seconds)
+        .def_readonly("resolution_seconds", &ProofStatistics::resolution_seconds)
+        .def_readonly("generated", &ProofStatistics::generated, "Resolvents generated.")
+        .def_readonly("kept", &ProofStatistics::kept, "Resolvents kept after the redundancy checks.")
+        .def_readonly("subsumed", &ProofStatistics::subsumed, "Resolvents subsumed by a clause of the set.")
+        .def_readonly("tautologies", &ProofStatistics::tautologies)
+        .def_readonly("unification_attempts", &ProofStatistics::unification_attempts)
+        .def_readonly("unification_successes", &ProofStatistics::unification_successes)
+        .def_readonly("index_hits", &ProofStatistics::index_hits,
+            "Partners the literal index offered for the given clauses.")
+        .def_readonly("peak_clauses", &ProofStatistics::peak_clauses, "Largest size of the clause set.")
+        .def_readonly("term_allocations", &ProofStatistics::term_allocations, "Formula nodes built by all stages.")
+        .def_readonly("peak_memory", &ProofStatistics::peak_memory, "Bytes of the clause store at its largest.")
+        .def_readonly("peak_usage", &ProofStatistics::peak_usage, "MemoryUsage with every category at its largest.")
+        .def("__repr__", [](const ProofStatistics &self) {
+                return "<Statistics " + std::to_string(self.generated) + " generated, " +
+                       std::to_string(self.kept) + " kept>";
+            });
+
+    py::class_<ProgressIterator>(rz, "ProgressIterator", R"pbdoc(
+        Iterator over the Progress reports of a proof started by
+        iterate_resolution. Dropping it cancels the proof.
+    )pbdoc")
+        .def("__iter__", [](ProgressIterator &self) -> ProgressIterator& { return self; },
+             py::return_value_policy::reference_internal)
+        .def("__next__", &ProgressIterator::Next)
+        .def("cancel", &ProgressIterator::Cancel, "Stop the proof, the iteration then ends.")
+        .def_property_readonly("result", &ProgressIterator::Result,
+            "The (success, proof_history) tuple of make_resolution once the iteration ended, None before.");
+
+    py::class_<ProofLiteral>(rz, "Literal", R"pbdoc(
+        A literal of a Clause.
+    )pbdoc")
+        .def_property_readonly("negated", [](const ProofLiteral &self) {
+                return self.literal->type == FormulaType::NOT;
+            })
+        .def_property_readonly("predicate", [](const ProofLiteral &self) {
+                return LiteralAtom(self.literal)->str;
+            })
+        .def_property_readonly("arguments", [](const ProofLiteral &self) {
+                std::vector<std::string> arguments;
+                for (Formula *arg : LiteralAtom(self.literal)->children) arguments.push_back(FormulaAsString(arg));
+                return arguments;
+            }, "Terms of the atom as strings.")
+        .def("__str__", [](const ProofLiteral &self) { return FormulaAsString(self.literal); });
+
+    py::class_<ProofClause>(rz, "Clause", R"pbdoc(
+        A clause of a Proof, referencing the native proof without copying it.
+    )pbdoc")
+        .def_property_readonly("id", [](const ProofClause &self) { return self.index; },
+            "Position in the proof, parents always have smaller ids.")
+        .def_property_readonly("parents", [](const ProofClause &self) -> py::object {
+                if (self.dag->Parent1(self.index) < 0) return py::none();
+                return py::make_tuple(self.dag->Parent1(self.index), self.dag->Parent2(self.index));
+            }, "Ids of the two resolved clauses, None for premises.")
+        .def_property_readonly("is_premise", [](const ProofClause &self) {
+                return self.dag->Parent1(self.index) < 0;
+            })
+        .def_property_readonly("is_empty", [](const ProofClause &self) {
+                return self.dag->Clause(self.index)->type == FormulaType::EMPTY;
+            })
+        .def_property_readonly("literals", [](const ProofClause &self) {
+                std::vector<Formula*> literals;
+                ClauseLiterals(self.dag->Clause(self.index), literals);
+
+                std::vector<ProofLiteral> result;
+                for (Formula *literal : literals) result.push_back({self.dag, literal});
+                return result;
+            })
+        .def_property_readonly("symbols", [](const ProofClause &self) {
+                SymbolTable symbols;
+                symbols.Add(self.dag->Clause(self.index));
+                return std::vector<std::string>(symbols.Names().begin(), symbols.Names().end());
+            }, "Sorted names of the predicates, functions and constants.")
+        .def("tstp", [](const ProofClause &self) { return ClauseAsTstp(self.dag->Clause(self.index)); })
+        .def(py::pickle(
+            [](const ProofClause &self) { return py::make_tuple(self.dag, self.index); },
+            [](const py::tuple &state) {
+                auto dag = state[0].cast<std::shared_ptr<ProofDag>>();
+                size_t index = state[1].cast<size_t>();
+                if (index >= dag->Size()) throw py::value_error("clause id out of range");
+                return ProofClause{dag, index};
+            }))
+        .def("__str__", [](const ProofClause &self) { return FormulaAsString(self.dag->Clause(self.index)); })
+        .def("__repr__", [](const ProofClause &self) {
+                return "<Clause " + std::to_string(self.index) + " " + FormulaAsString(self.dag->Clause(self.index)) + ">";
+            });
+
+    py::class_<ProofDag, std::shared_ptr<ProofDag>>(rz, "Proof", py::buffer_protocol(), R"pbdoc(
+        A refutation as a DAG of clauses, returned with structured=True.
+
+        Clauses are numbered in derivation order and the last one is the
+        empty clause. The buffer
+        holds one (parent1, parent2) row of int32 per clause, -1 for
+        premises, so numpy.asarray(proof) exports the DAG without a copy.
+        Proofs and their clauses can be pickled.
+
+        Example:
+            >>> success, proof = rzlogic.make_resolution(premises, structured=True)
+            >>> parents = numpy.asarray(proof)
+            >>> [str(clause) for clause in proof if clause.is_premise]
+    )pbdoc")
+        .def_buffer([](ProofDag &self) -> py::buffer_info {
+                return py::buffer_info(const_cast<int32_t*>(self.ParentData()), sizeof(int32_t),
+                                       py::format_descriptor<int32_t>::format(), 2,
+                                       {(py::ssize_t)self.Size(), (py::ssize_t)2},
+                                       {(py::ssize_t)(2 * sizeof(int32_t)), (py::ssize_t)sizeof(int32_t)},
+                                       true);
+            })
+        .def("__len__", &ProofDag::Size)
+        .def("__getitem__", [](std::shared_ptr<ProofDag> self, py::ssize_t i) {
+                if (i < 0) i += self->Size();
+                if (i < 0 || i >= (py::ssize_t)self->Size()) throw py::index_error("clause id out of range");
+                return ProofClause{self, (size_t)i};
+            })
+        .def_property_readonly("steps", [](const ProofDag &self) {
+                std::vector<StepWrapper> steps;
+                for (size_t i = 0; i < self.Size(); i++)
+                {
+                    if (self.Parent1(i) < 0) continue;
+                    steps.emplace_back(FormulaAsString(self.Clause(self.Parent1(i))),
+                                       FormulaAsString(self.Clause(self.Parent2(i))),
+                                       FormulaAsString(self.Clause(i)));
+                }
+                return steps;
+            }, "The (premise1, premise2, resolvent) tuples of the unstructured result.")
+        .def_property_readonly("search_ids", [](const ProofDag &self) {
+                std::vector<int> ids;
+                for (size_t i = 0; i < self.Size(); i++) ids.push_back(self.SearchId(i));
+                return ids;
+            }, "Clause ids of the search, as written to a proof log.")
+        .def(py::pickle(
+            [](const ProofDag &self) { return py::bytes(SerializeProof(self)); },
+            [](const py::bytes &state) {
+                auto data = BytesData(state);
+                return std::shared_ptr<ProofDag>(DeserializeProof(data.first, data.second));
+            }));
+
     rz.def("make_resolution", &MakeResolutionWrapper, R"pbdoc(
         Perform resolution method on logical premises.
+
+        The GIL is released while the premises are parsed, normalized and
+        resolved, so other Python threads keep running.
         
         Args:
             premises: List of strings representing logical formulas in text form.
@@ -70,16 +957,60 @@ PYBIND11_MODULE(rzlogic, rz)
                      Example: ["(forall x (implies (H x) (M x)))",
                                 "(H a)",
                                 "(not (M a))"]
+            threads: Number of threads clausifying the premises and
+                     generating inferences during saturation (default 1).
+                     The result and the history are the same for any
+                     number of threads.
+            portfolio: Number of search strategies raced on separate threads
+                     (default 0, off). The first refutation wins and the other
+                     strategies are cancelled; threads is ignored in this mode.
+            timeout: Wall time budget of the search in seconds (0 - unlimited).
+            max_clauses: Budget of generated clauses (0 - unlimited).
+            max_memory: Budget of bytes held by the search: the clauses,
+                     the literal index and the proof, see MemoryUsage
+                     (0 - unlimited).
+            max_term_depth: Resolvents with deeper terms are dropped
+                     (0 - unlimited).
+            cancel: CancellationToken to stop the search from another thread.
+            proof_log: Path of a file receiving every inference as it is made
+                     (default "", off). In portfolio mode only the winning
+                     proof is written.
+            proof_log_format: "tstp" for cnf(...) lines readable by TPTP
+                     tools or "binary" for compact varint records.
+            cache: ProofCache answering problems solved before, up to
+                     renaming of variables and reordering of premises
+                     (default None). A cached proof comes back in the
+                     variable names of the call. Results that depend on a
+                     budget are not cached, and proofs with a proof_log
+                     always search.
+            structured: Return the proof as a Proof object instead of the
+                     list of string tuples (default False). Structured
+                     proofs do not use the cache.
+            progress: Callable receiving a Progress report every
+                     progress_interval seconds and once at the end
+                     (default None). It runs on the proving thread with
+                     the GIL held. Returning False cancels the search; an
+                     exception cancels it and is raised by make_resolution.
+            progress_interval: Seconds between progress reports (default 0.5).
+            statistics: Append a Statistics object with the stage times and
+                     the counters of the search to the result (default
+                     False). Collecting them costs a few clock reads per
+                     stage; without it nothing is measured.
         
         Returns:
-            tuple: (success, proof_history)
-            - success (bool): True if contradiction was found (proof successful),
-                            False otherwise
-            - proof_history (list): List of resolution steps as tuples
-                            (premise1, premise2, resolvent)
+            tuple: (success, proof_history), or (success, proof_history,
+            statistics) with statistics=True
+            - success (bool or None): True if contradiction was found (proof
+                            successful), False if the premises are saturated
+                            without one, None if a budget ran out or the
+                            search was cancelled
+            - proof_history (list): Resolution steps deriving the empty
+                            clause as tuples (premise1, premise2, resolvent),
+                            empty unless the proof succeeded
         
         Raises:
             RuntimeError: If formula parsing fails
+            KeyboardInterrupt: If interrupted while searching
         
         Example:
             >>> import rzlogic
@@ -89,5 +1020,298 @@ PYBIND11_MODULE(rzlogic, rz)
             >>> for step in history:
             ...     print(f"Resolved {step[0]} and {step[1]} to get {step[2]}")
     )pbdoc",
-    py::arg("premises"));
+    RZLOGIC_PROOF_ARGS);
+
+    rz.def("submit", &SubmitWrapper, R"pbdoc(
+        Start make_resolution on the native thread pool and return at once.
+
+        Takes the same arguments as make_resolution. The GIL is not held
+        while the proof runs, so many proofs progress concurrently.
+
+        Returns:
+            concurrent.futures.Future: resolves to the (success, proof_history)
+            tuple of make_resolution. Use a CancellationToken to stop the proof.
+
+        Example:
+            >>> future = rzlogic.submit(premises, timeout=5)
+            >>> success, history = future.result()
+    )pbdoc",
+    RZLOGIC_PROOF_ARGS);
+
+    rz.def("make_resolution_async", &MakeResolutionAsyncWrapper, R"pbdoc(
+        Awaitable version of make_resolution for asyncio code.
+
+        Takes the same arguments as make_resolution and must be called from
+        a running event loop. The proof runs on the native thread pool.
+
+        Example:
+            >>> success, history = await rzlogic.make_resolution_async(premises)
+    )pbdoc",
+    RZLOGIC_PROOF_ARGS);
+
+    rz.def("iterate_resolution", &IterateResolutionWrapper, R"pbdoc(
+        Start make_resolution on the native thread pool and iterate over
+        its Progress reports.
+
+        Takes the arguments of make_resolution except proof_log and
+        progress. Waiting for the next report releases the GIL. The
+        iteration ends with the search, then result holds what
+        make_resolution would have returned.
+
+        Example:
+            >>> proof = rzlogic.iterate_resolution(premises, progress_interval=0.1)
+            >>> for report in proof:
+            ...     print(report.generated, report.clauses, report.units)
+            ...     if report.seconds > 10:
+            ...         proof.cancel()
+            >>> success, history = proof.result
+    )pbdoc",
+    py::arg("premises"),
+    py::arg("threads") = 1,
+    py::arg("portfolio") = 0,
+    py::arg("timeout") = 0.0,
+    py::arg("max_clauses") = 0,
+    py::arg("max_memory") = 0,
+    py::arg("max_term_depth") = 0,
+    py::arg("cancel") = py::none(),
+    py::arg("cache") = py::none(),
+    py::arg("structured") = false,
+    py::arg("progress_interval") = 0.5);
+
+    rz.def("make_resolution_batch", &MakeResolutionBatchWrapper, R"pbdoc(
+        Prove many independent problems in one call.
+
+        Every problem goes through parsing, normalization and resolution on
+        a native thread pool with the GIL released. Workers reuse their
+        buffers between problems.
+
+        Args:
+            problems: List of premise lists, each one as make_resolution takes.
+            threads: Number of worker threads (default 0 - one per core).
+            timeout, max_clauses, max_memory, max_term_depth: Budgets applied
+                     to every problem separately, see make_resolution.
+            cancel: CancellationToken stopping all remaining problems.
+
+        Returns:
+            list: (success, proof_history) tuples of make_resolution, in the
+            order of problems.
+
+        Raises:
+            RuntimeError: If a premise of any problem fails to parse
+            KeyboardInterrupt: If interrupted while proving
+
+        Example:
+            >>> results = rzlogic.make_resolution_batch([p1, p2, p3], threads=8)
+    )pbdoc",
+    py::arg("problems"),
+    py::arg("threads") = 0,
+    py::arg("timeout") = 0.0,
+    py::arg("max_clauses") = 0,
+    py::arg("max_memory") = 0,
+    py::arg("max_term_depth") = 0,
+    py::arg("cancel") = py::none());
+
+    rz.attr("tracing_available") = TracingAvailable();
+
+    rz.def("start_tracing", &StartTracing, R"pbdoc(
+        Start recording a timeline of the prover stages, dropping what was
+        recorded before. Must not be called while proofs are running.
+        Recording needs a module built with -DRZLOGIC_TRACING=ON, see
+        tracing_available; otherwise nothing is recorded.
+    )pbdoc");
+
+    rz.def("stop_tracing", [](const std::string &path)
+    {
+        StopTracing();
+        WriteTrace(path);
+    },
+    R"pbdoc(
+        Stop recording and write the timeline to path in the Chrome trace
+        event format, for chrome://tracing or ui.perfetto.dev.
+
+        Raises:
+            RuntimeError: If the module was built without tracing or the
+                          file cannot be written
+    )pbdoc",
+    py::arg("path"));
+
+    py::class_<SessionCheckpoint>(rz, "SessionCheckpoint", R"pbdoc(
+        State of a ProverSession returned by ProverSession.checkpoint().
+    )pbdoc");
+
+    py::class_<PyProverSession>(rz, "ProverSession", R"pbdoc(
+        Incremental prover keeping its clauses between proofs.
+
+        Premises and goals are normalized once when added. prove() continues
+        from the clauses derived by the previous calls, so adding one fact
+        to a large background theory costs only the new inferences. Negated
+        goals form the set of support.
+
+        Sessions pickle to the snapshot format with their derived clauses,
+        so a clausified theory can be sent to multiprocessing workers
+        without parsing it again there. The last proof is not pickled.
+
+        Example:
+            >>> session = rzlogic.ProverSession()
+            >>> session.add_premise("(forall x (implies (H x) (M x)))")
+            >>> mark = session.checkpoint()
+            >>> session.add_premise("(H a)")
+            >>> session.add_goal("(M a)")
+            >>> success, history = session.prove()
+            >>> session.restore(mark)   # forget (H a) and the goal
+    )pbdoc")
+        .def(py::init<>())
+        .def("add_premise", [](PyProverSession &self, const std::string &formula) {
+                SessionUse use(self);
+                self.session.AddPremise(formula);
+            },
+            "Add a premise. Raises RuntimeError if it fails to parse.",
+            py::arg("formula"))
+        .def("add_goal", [](PyProverSession &self, const std::string &formula) {
+                SessionUse use(self);
+                self.session.AddGoal(formula);
+            },
+            "Add a formula to prove, its negation joins the clauses.",
+            py::arg("formula"))
+        .def("prove", &SessionProveWrapper, R"pbdoc(
+            Search for a refutation of everything added so far.
+
+            Takes threads, timeout, max_clauses, max_memory, max_term_depth,
+            cancel, structured, progress and progress_interval as
+            make_resolution does; the budgets apply to this call only. A
+            search that ran out of them resumes on the next call.
+
+            Returns:
+                tuple: (success, proof_history) as make_resolution returns
+        )pbdoc",
+        py::arg("threads") = 1,
+        py::arg("timeout") = 0.0,
+        py::arg("max_clauses") = 0,
+        py::arg("max_memory") = 0,
+        py::arg("max_term_depth") = 0,
+        py::arg("cancel") = py::none(),
+        py::arg("structured") = false,
+        py::arg("progress") = py::none(),
+        py::arg("progress_interval") = 0.5)
+        .def("checkpoint", [](PyProverSession &self) {
+                SessionUse use(self);
+                return self.session.Checkpoint();
+            },
+            "Remember the current premises, goals and derived clauses.")
+        .def("restore", [](PyProverSession &self, const SessionCheckpoint &checkpoint) {
+                SessionUse use(self);
+                self.session.Restore(checkpoint);
+            },
+            "Retract everything added after the checkpoint. Later checkpoints become invalid.",
+            py::arg("checkpoint"))
+        .def("save_snapshot", [](PyProverSession &self, const std::string &path, bool saturation) {
+                SessionUse use(self);
+                self.session.SaveSnapshot(path, saturation);
+            },
+            R"pbdoc(
+            Compile the session into a binary snapshot file.
+
+            With saturation the derived clauses are stored too, so sessions
+            loaded from the file skip the search done so far as well.
+            )pbdoc",
+            py::arg("path"),
+            py::arg("saturation") = true)
+        .def_static("load_snapshot", [](const std::string &path) {
+                auto py_session = std::make_unique<PyProverSession>();
+                {
+                    py::gil_scoped_release release;
+                    py_session->session.LoadSnapshot(path);
+                }
+                return py_session;
+            },
+            R"pbdoc(
+            Create a session from a file written by save_snapshot.
+
+            The file is memory-mapped and decoded without parsing any
+            formula. Raises RuntimeError if it is not a valid snapshot.
+            )pbdoc",
+            py::arg("path"))
+        .def_property_readonly("clauses", [](PyProverSession &self) {
+                SessionUse use(self);
+                std::vector<std::string> clauses;
+                for (Formula *f : self.session.Clauses()) clauses.push_back(FormulaAsString(f));
+                return clauses;
+            },
+            "Clauses of the premises and negated goals in the order they were added.")
+        .def_property_readonly("memory", [](PyProverSession &self) {
+                SessionUse use(self);
+                return self.session.Memory().Live();
+            },
+            "MemoryUsage of the searched clauses, the index and the current proof.")
+        .def_property_readonly("peak_memory", [](PyProverSession &self) {
+                SessionUse use(self);
+                return self.session.Memory().Peak();
+            },
+            "MemoryUsage with every category at its largest so far.")
+        .def(py::pickle(
+            [](PyProverSession &self) {
+                SessionUse use(self);
+                std::string buffer;
+                {
+                    py::gil_scoped_release release;
+                    buffer = self.session.Serialize();
+                }
+                return py::bytes(buffer);
+            },
+            [](const py::bytes &state) {
+                auto data = BytesData(state);
+                auto py_session = std::make_unique<PyProverSession>();
+                {
+                    // the caller holds state, the buffer stays valid
+                    py::gil_scoped_release release;
+                    py_session->session.Deserialize(data.first, data.second);
+                }
+                return py_session;
+            }));
+
+    py::module_ generators = rz.def_submodule("generators", R"pbdoc(
+        Synthetic problem families for stress tests and benchmarks.
+
+        Every function returns premises for make_resolution. The families
+        other than nonterminating are unsatisfiable.
+
+        Example:
+            >>> for n in range(1, 10):
+            ...     premises = rzlogic.generators.chain(2 ** n)
+            ...     success, history = rzlogic.make_resolution(premises, timeout=10)
+    )pbdoc");
+
+    generators.def("pigeonhole", [](int holes) { return PigeonholeProblem(holes).premises; },
+        "holes + 1 pigeons in holes holes, exponential for resolution.",
+        py::arg("holes"));
+    generators.def("chain", [](int length) { return ImplicationChainProblem(length).premises; },
+        "A chain of length implications from (P0 a) to the negated (Plength a).",
+        py::arg("length"));
+    generators.def("skolem", [](int depth) { return SkolemNestingProblem(depth).premises; },
+        "depth alternations of forall and exists against the negated matrix.",
+        py::arg("depth"));
+    generators.def("distribution", [](int width) { return DistributionProblem(width).premises; },
+        "A disjunction of width conjunctions, 2^width clauses in CNF.",
+        py::arg("width"));
+    generators.def("facts", [](int facts, int rules) { return FactBaseProblem(facts, rules).premises; },
+        "facts ground facts and a chain of rules rules long.",
+        py::arg("facts"), py::arg("rules") = 4);
+    generators.def("nonterminating", [](int count) { return NonTerminatingProblem(count).premises; },
+        "count successor rules that saturate forever, only a budget stops them.",
+        py::arg("count"));
+    generators.def("generate", [](const std::string &family, int size) {
+            GeneratedProblem problem = GenerateProblem(family, size);
+            return py::make_tuple(problem.premises, ProofResultToPython(problem.expected));
+        },
+        R"pbdoc(
+        Problem of a family by name, one of families.
+
+        Returns:
+            tuple: (premises, expected) where expected is the success value
+            make_resolution should return, None for nonterminating.
+        )pbdoc",
+        py::arg("family"), py::arg("size"));
+    generators.attr("families") = GeneratorFamilies();
+
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() { AsyncShutdownToken().Cancel(); }));
 }
@@ -0,0 +1,188 @@
+#include "generators.hpp"
+#include <stdexcept>
+
+namespace rzlogic {
+
+// Names of constants start before 'n' and names of variables from 'n' on,
+// see the parser.
+
+static std::string Atom(const std::string &predicate, const std::string &args)
+{
+    return "(" + predicate + " " + args + ")";
+}
+
+static std::string Numbered(const std::string &base, int i)
+{
+    return base + std::to_string(i);
+}
+
+// right-nested (op f1 (op f2 ... fn))
+static std::string Nested(const std::string &op, const std::vector<std::string> &formulas)
+{
+    std::string text = formulas.back();
+    for (size_t i = formulas.size() - 1; i-- > 0; ) {
+        text = "(" + op + " " + formulas[i] + " " + text + ")";
+    }
+    return text;
+}
+
+static void CheckSize(int size, int min)
+{
+    if (size < min) {
+        throw std::runtime_error("Problem size must be at least " + std::to_string(min));
+    }
+}
+
+GeneratedProblem PigeonholeProblem(int holes)
+{
+    CheckSize(holes, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("pigeonhole-", holes);
+
+    auto in = [](int pigeon, int hole) { return Atom("In", Numbered("c", pigeon) + " " + Numbered("d", hole)); };
+
+    // every pigeon sits in a hole
+    for (int pigeon = 0; pigeon <= holes; pigeon++)
+    {
+        std::vector<std::string> places;
+        for (int hole = 0; hole < holes; hole++) places.push_back(in(pigeon, hole));
+        problem.premises.push_back(Nested("or", places));
+    }
+
+    // no two pigeons share one
+    for (int hole = 0; hole < holes; hole++)
+    {
+        for (int first = 0; first <= holes; first++)
+        {
+            for (int second = first + 1; second <= holes; second++)
+            {
+                problem.premises.push_back("(or (not " + in(first, hole) + ") (not " + in(second, hole) + "))");
+            }
+        }
+    }
+
+    return problem;
+}
+
+GeneratedProblem ImplicationChainProblem(int length)
+{
+    CheckSize(length, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("chain-", length);
+
+    problem.premises.push_back(Atom("P0", "a"));
+    for (int i = 0; i < length; i++)
+    {
+        problem.premises.push_back("(forall x (implies " + Atom(Numbered("P", i), "x") + " " +
+                                   Atom(Numbered("P", i + 1), "x") + "))");
+    }
+    problem.premises.push_back("(not " + Atom(Numbered("P", length), "a") + ")");
+
+    return problem;
+}
+
+GeneratedProblem SkolemNestingProblem(int depth)
+{
+    CheckSize(depth, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("skolem-", depth);
+
+    std::string args;
+    for (int i = 1; i <= depth; i++) args += (i > 1 ? " " : "") + Numbered("x", i) + " " + Numbered("y", i);
+
+    std::string theory = Atom("R", args);
+    std::string negated = "(not " + Atom("R", args) + ")";
+    for (int i = depth; i >= 1; i--)
+    {
+        theory = "(forall " + Numbered("x", i) + " (exists " + Numbered("y", i) + " " + theory + "))";
+        negated = "(forall " + Numbered("x", i) + " (forall " + Numbered("y", i) + " " + negated + "))";
+    }
+
+    problem.premises = {theory, negated};
+    return problem;
+}
+
+GeneratedProblem DistributionProblem(int width)
+{
+    CheckSize(width, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("distribution-", width);
+
+    std::vector<std::string> conjunctions;
+    for (int i = 0; i < width; i++)
+    {
+        std::string a = Atom(Numbered("A", i), "c");
+        std::string b = Atom(Numbered("B", i), "c");
+        conjunctions.push_back("(and " + a + " " + b + ")");
+        problem.premises.push_back("(not " + a + ")");
+    }
+    problem.premises.insert(problem.premises.begin(), Nested("or", conjunctions));
+
+    return problem;
+}
+
+GeneratedProblem FactBaseProblem(int facts, int rules)
+{
+    CheckSize(facts, 1);
+    CheckSize(rules, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("facts-", facts) + Numbered("-", rules);
+
+    for (int i = 0; i < facts; i++) problem.premises.push_back(Atom("Human", Numbered("c", i)));
+
+    problem.premises.push_back("(forall x (implies (Human x) (R1 x)))");
+    for (int i = 1; i < rules; i++)
+    {
+        problem.premises.push_back("(forall x (implies " + Atom(Numbered("R", i), "x") + " " +
+                                   Atom(Numbered("R", i + 1), "x") + "))");
+    }
+    problem.premises.push_back("(not " + Atom(Numbered("R", rules), Numbered("c", facts - 1)) + ")");
+
+    return problem;
+}
+
+GeneratedProblem NonTerminatingProblem(int count)
+{
+    CheckSize(count, 1);
+
+    GeneratedProblem problem;
+    problem.name = Numbered("nonterminating-", count);
+    problem.expected = ProofResult::UNKNOWN;
+
+    for (int i = 0; i < count; i++)
+    {
+        std::string p = Numbered("P", i);
+        problem.premises.push_back(Atom(p, "a"));
+        problem.premises.push_back("(forall x (implies " + Atom(p, "x") + " " + Atom(p, "(" + Numbered("f", i) + " x)") + "))");
+    }
+    problem.premises.push_back("(not (Q a))");
+
+    return problem;
+}
+
+const std::vector<std::string> &GeneratorFamilies()
+{
+    static const std::vector<std::string> families = {
+        "pigeonhole", "chain", "skolem", "distribution", "facts", "nonterminating"
+    };
+    return families;
+}
+
+GeneratedProblem GenerateProblem(const std::string &family, int size)
+{
+    if (family == "pigeonhole") return PigeonholeProblem(size);
+    if (family == "chain") return ImplicationChainProblem(size);
+    if (family == "skolem") return SkolemNestingProblem(size);
+    if (family == "distribution") return DistributionProblem(size);
+    if (family == "facts") return FactBaseProblem(size, size / 4 + 1);
+    if (family == "nonterminating") return NonTerminatingProblem(size);
+
+    throw std::runtime_error("Unknown problem family " + family);
+}
+
+} // namespace rzlogic
@@ -1,6 +1,16 @@
 #include "logic.hpp"
+#include "proof_log.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 #include <functional>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
 
 namespace rzlogic {
 
@@ -61,6 +71,17 @@ void DeleteFormula(Formula *f)
     delete f;
 }
 
+size_t FormulaBytes(Formula *f)
+{
+    size_t bytes = sizeof(Formula) + f->children.capacity() * sizeof(Formula*);
+
+    // short names fit in the string itself, an empty one has that capacity
+    if (f->str.capacity() > std::string().capacity()) bytes += f->str.capacity() + 1;
+
+    for (Formula *child : f->children) bytes += FormulaBytes(child);
+    return bytes;
+}
+
 void DoForAll(Formula *f, std::function<void(Formula*)> func)
 {
     std::vector<Formula*> stack;
@@ -255,9 +276,11 @@ void ReplaceVariable(Formula *f, const std::string &old_var, Formula *new_term,
                 DeleteFormula(old_child);
             }
 
+            // every occurrence gets its own arguments
             f->str = new_term->str;
             f->type = new_term->type;
-            f->children = new_term->children;
+            f->children.clear();
+            for (Formula *child : new_term->children) f->children.push_back(CloneFormula(child));
         }
     } 
     else 
@@ -269,7 +292,35 @@ void ReplaceVariable(Formula *f, const std::string &old_var, Formula *new_term,
     }
 }
 
-void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem_counter) 
+void SymbolTable::Add(Formula *f)
+{
+    DoForAll(f, [this](Formula *ff) {
+        if (ff->type == FormulaType::PREDICATE ||
+            ff->type == FormulaType::FUNCTION  ||
+            ff->type == FormulaType::CONSTANT)
+        {
+            names.insert(ff->str);
+        }
+    });
+}
+
+std::string SymbolTable::UniqueName(const std::string &base)
+{
+    // names are never removed, so the indices tried before stay taken
+    int &idx = next_index[base];
+
+    std::string name = idx ? base + std::to_string(idx) : base;
+    while (names.count(name)) name = base + std::to_string(++idx);
+
+    names.insert(name);
+    return name;
+}
+
+// no parser accepts it in a name, so later formulas cannot mention a
+// Skolem symbol by accident
+static const char SKOLEM_PREFIX[] = "$";
+
+void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem_counter, SymbolTable *symbols) 
 {
     if (!f) return;
     
@@ -284,11 +335,13 @@ void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem
         {
             skolem_term = new Formula(FormulaType::CONSTANT);
             skolem_term->str = char(97 + skolem_counter++);
+            if (symbols) skolem_term->str = symbols->UniqueName(SKOLEM_PREFIX + skolem_term->str);
         }
         else 
         {
             skolem_term = new Formula(FormulaType::FUNCTION);
             skolem_term->str = char(110 + skolem_counter++);
+            if (symbols) skolem_term->str = symbols->UniqueName(SKOLEM_PREFIX + skolem_term->str);
             
             for (const auto& uv : universal_vars) 
             {
@@ -305,21 +358,21 @@ void Skolemize(Formula *f, std::vector<std::string> &universal_vars, int &skolem
         f->children = body->children;
 
         delete body;
-        delete skolem_term;
+        DeleteFormula(skolem_term);
 
-        Skolemize(f, universal_vars, skolem_counter);
+        Skolemize(f, universal_vars, skolem_counter, symbols);
     }
     else if (f->type == FormulaType::FORALL) 
     {
         universal_vars.push_back(f->str);
-        Skolemize(f->children[0], universal_vars, skolem_counter);
+        Skolemize(f->children[0], universal_vars, skolem_counter, symbols);
         universal_vars.pop_back();
     }
     else 
     {
         for (Formula* child : f->children) 
         {
-            Skolemize(child, universal_vars, skolem_counter);
+            Skolemize(child, universal_vars, skolem_counter, symbols);
         }
     }
 }
@@ -359,6 +412,17 @@ void MakeSkolemNormalForm(Formula *f)
     DropUniversalQuantifiers(f);
 }
 
+void MakeSkolemNormalForm(Formula *f, SymbolTable &symbols) 
+{
+    std::vector<std::string> universal_vars;
+    int skolem_counter = 0;
+
+    symbols.Add(f);
+    Skolemize(f, universal_vars, skolem_counter, &symbols);
+
+    DropUniversalQuantifiers(f);
+}
+
 void DistributeOrOverAnd(Formula *f) 
 {
     if (!f) return;
@@ -444,10 +508,15 @@ void MakeConjunctiveNormalForm(Formula *f)
                     {
                         return true;
                     }
-                    if (needsDistribution(child)) 
-                    {
-                        return true;
-                    }
+                }
+            }
+
+            // a distribution leaves new disjunctions under the conjunctions
+            for (Formula* child : formula->children) 
+            {
+                if (needsDistribution(child)) 
+                {
+                    return true;
                 }
             }
             return false;
@@ -461,6 +530,50 @@ void MakeConjunctiveNormalForm(Formula *f)
     } while (changed);
 }
 
+static thread_local size_t formula_allocations = 0;
+
+void *Formula::operator new(size_t size)
+{
+    formula_allocations++;
+    return ::operator new(size);
+}
+
+void Formula::operator delete(void *p)
+{
+    ::operator delete(p);
+}
+
+size_t FormulaAllocations()
+{
+    return formula_allocations;
+}
+
+void ProofStatistics::Add(const ProofStatistics &other)
+{
+    parse_seconds         += other.parse_seconds;
+    normalize_seconds     += other.normalize_seconds;
+    prenex_seconds        += other.prenex_seconds;
+    skolem_seconds        += other.skolem_seconds;
+    cnf_seconds           += other.cnf_seconds;
+    resolution_seconds    += other.resolution_seconds;
+    generated             += other.generated;
+    kept                  += other.kept;
+    subsumed              += other.subsumed;
+    tautologies           += other.tautologies;
+    unification_attempts  += other.unification_attempts;
+    unification_successes += other.unification_successes;
+    index_hits            += other.index_hits;
+    peak_clauses           = std::max(peak_clauses, other.peak_clauses);
+    term_allocations      += other.term_allocations;
+    peak_memory            = std::max(peak_memory, other.peak_memory);
+
+    for (size_t MemoryUsage::*category : {&MemoryUsage::terms, &MemoryUsage::clauses,
+                                          &MemoryUsage::index, &MemoryUsage::history})
+    {
+        peak_usage.*category = std::max(peak_usage.*category, other.peak_usage.*category);
+    }
+}
+
 Formula* CloneFormula(Formula *f) 
 {
     if (!f) return nullptr;
@@ -1171,72 +1284,897 @@ bool IsTautology(Formula *f)
     return false;
 }
 
-bool MakeResolution(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history)
+void ClauseLiterals(Formula *f, std::vector<Formula*> &literals)
 {
-    std::vector<Formula*> used_clauses = premises;
-    std::vector<std::pair<int, int>> tried_pairs;
+    std::vector<Formula*> stack;
+
+    stack.push_back(f);
 
-    while (true)
+    while (!stack.empty())
     {
-        bool found_new_premise = false;
+        Formula *temp = stack.back();
+        stack.pop_back();
 
-        for (int i = 0; i < used_clauses.size(); ++i)
+        switch (temp->type)
         {
-            for (int j = i + 1; j < used_clauses.size(); ++j)
+            case FormulaType::OR:
             {
-                auto it_pair = std::find_if(tried_pairs.begin(), tried_pairs.end(),
-                [i, j] (const std::pair<int, int> p) 
-                {
-                    return (p.first == i) and (p.second == j);
-                });
+                stack.push_back(temp->children[1]);
+                stack.push_back(temp->children[0]);
+                break;
+            }
+            case FormulaType::PREDICATE:
+            case FormulaType::NOT:
+            {
+                literals.push_back(temp);
+                break;
+            }
+            default: break;
+        }
+    }
+}
 
-                if (it_pair != tried_pairs.end()) continue;
-                
-                tried_pairs.push_back({i, j});
+bool Subsumes(Formula *f1, Formula *f2)
+{
+    std::vector<Formula*> literals1;
+    std::vector<Formula*> literals2;
 
-                if(Unificate(used_clauses[i], used_clauses[j]))
-                {
-                    Formula *resolver = FindResolver(used_clauses[i], used_clauses[j]);
+    ClauseLiterals(f1, literals1);
+    ClauseLiterals(f2, literals2);
 
-                    if (resolver)
-                    {
-                        Formula *res = ResolutionStep(used_clauses[i], used_clauses[j], resolver);
-                        if (res->type == FormulaType::EMPTY)
-                    {
-                            history.push_back({CloneFormula(used_clauses[i]), CloneFormula(used_clauses[j]), CloneFormula(res)});
-                            return true;
-                        }
-
-                        if (!IsTautology(res))
-                        {
-                            bool is_new_clause = true;
-                            for (Formula *premise : used_clauses)
-                            {
-                                if (FormulasEqual(res, premise))
-                                {
-                                    is_new_clause = false;
-                                    break;
-                                }
-                            }
-                            
-                            if (is_new_clause)
-                            {   
-                                history.push_back({CloneFormula(used_clauses[i]), CloneFormula(used_clauses[j]), CloneFormula(res)});
-                                used_clauses.push_back(res);
-                                found_new_premise = true;
-                            }
-                        }
-                    }
-                }
+    for (Formula *l1 : literals1)
+    {
+        bool found = false;
+        for (Formula *l2 : literals2)
+        {
+            if (FormulasEqual(l1, l2))
+            {
+                found = true;
+                break;
             }
         }
 
-        if (!found_new_premise)
+        if (!found) return false;
+    }
+
+    return true;
+}
+
+int FormulaWeight(Formula *f)
+{
+    int weight = 0;
+    DoForAll(f, [&weight](Formula *) { weight++; });
+    return weight;
+}
+
+int TermDepth(Formula *f)
+{
+    int depth = 0;
+    for (Formula *child : f->children)
+    {
+        depth = std::max(depth, TermDepth(child));
+    }
+
+    return (f->type == FormulaType::FUNCTION) ? depth + 1 : depth;
+}
+
+Formula *LiteralAtom(Formula *literal)
+{
+    return (literal->type == FormulaType::NOT) ? literal->children[0] : literal;
+}
+
+// heavier atoms are greater, equal weights are compared as strings
+bool AtomGreater(Formula *a1, Formula *a2)
+{
+    int w1 = FormulaWeight(a1);
+    int w2 = FormulaWeight(a2);
+
+    if (w1 != w2) return w1 > w2;
+    return FormulaAsString(a1) > FormulaAsString(a2);
+}
+
+Formula *MaximalLiteral(Formula *f)
+{
+    std::vector<Formula*> literals;
+    ClauseLiterals(f, literals);
+
+    Formula *max = nullptr;
+    for (Formula *literal : literals)
+    {
+        if (!max || AtomGreater(LiteralAtom(literal), LiteralAtom(max)))
         {
-            break;
+            max = literal;
+        }
+    }
+
+    return max;
+}
+
+Formula *MakeResolvent(Formula *f1, Formula *f2, bool ordered, bool *unified)
+{
+    // Unificate rewrites its arguments, so the parents stay untouched and
+    // can be shared between threads
+    Formula *f1_clone = CloneFormula(f1);
+    Formula *f2_clone = CloneFormula(f2);
+    Formula *res = nullptr;
+
+    bool unifiable = Unificate(f1_clone, f2_clone);
+    if (unified) *unified = unifiable;
+
+    if (unifiable)
+    {
+        Formula *resolver = nullptr;
+
+        if (ordered)
+        {
+            Formula *max1 = MaximalLiteral(f1_clone);
+            Formula *max2 = MaximalLiteral(f2_clone);
+
+            if (max1 && max2 && max1->type != max2->type &&
+                FormulasEqual(LiteralAtom(max1), LiteralAtom(max2)))
+            {
+                resolver = CloneFormula(LiteralAtom(max1));
+            }
         }
+        else
+        {
+            resolver = FindResolver(f1_clone, f2_clone);
+        }
+
+        if (resolver)
+        {
+            res = ResolutionStep(f1_clone, f2_clone, resolver);
+            DeleteFormula(resolver);
+        }
+    }
+
+    DeleteFormula(f1_clone);
+    DeleteFormula(f2_clone);
+    return res;
+}
+
+bool IsRedundant(Formula *f, std::vector<Formula*> &clauses)
+{
+    for (Formula *clause : clauses)
+    {
+        if (Subsumes(clause, f)) return true;
     }
 
     return false;
 }
+
+bool IsNegativeClause(Formula *f)
+{
+    std::vector<Formula*> literals;
+    ClauseLiterals(f, literals);
+
+    for (Formula *literal : literals)
+    {
+        if (literal->type != FormulaType::NOT) return false;
+    }
+
+    return true;
+}
+
+void DeleteHistory(std::vector<ResolutionStepInfo> &history)
+{
+    for (ResolutionStepInfo &step : history)
+    {
+        DeleteFormula(step.premise1);
+        DeleteFormula(step.premise2);
+        DeleteFormula(step.resolvent);
+    }
+
+    history.clear();
+}
+
+void ExtractProof(std::vector<Formula*> &clauses, std::vector<ClauseParents> &parents, int root,
+                  std::vector<ResolutionStepInfo> &history)
+{
+    // parents always have smaller ids, so marking backwards from the root
+    // visits every needed clause once and yields the steps in order
+    std::vector<bool> needed(root + 1, false);
+    needed[root] = true;
+
+    for (int id = root; id >= 0; --id)
+    {
+        if (!needed[id] || parents[id].parent1 < 0) continue;
+
+        needed[parents[id].parent1] = true;
+        needed[parents[id].parent2] = true;
+    }
+
+    for (int id = 0; id <= root; ++id)
+    {
+        if (!needed[id] || parents[id].parent1 < 0) continue;
+
+        int p1 = parents[id].parent1;
+        int p2 = parents[id].parent2;
+
+        ResolutionStepInfo step = {CloneFormula(clauses[p1]), CloneFormula(clauses[p2]), CloneFormula(clauses[id])};
+        step.premise1_id  = p1;
+        step.premise2_id  = p2;
+        step.resolvent_id = id;
+        history.push_back(step);
+    }
+}
+
+SaturationState::SaturationState()
+    : index(Accounted<std::pair<const IndexKey, Positions>>(&memory, &MemoryUsage::index)),
+      passive_by_age(Accounted<int>(&memory, &MemoryUsage::index)),
+      passive_by_weight(Accounted<std::pair<int, int>>(&memory, &MemoryUsage::index))
+{
+}
+
+SaturationState::~SaturationState()
+{
+    for (size_t id = 0; id < clauses.size(); ++id)
+    {
+        if (parents[id].parent1 >= 0) DeleteFormula(clauses[id]);
+    }
+}
+
+void SaturationState::AddPassive(int id)
+{
+    weights.push_back(FormulaWeight(clauses[id]));
+    passive_by_age.insert(id);
+    passive_by_weight.insert({weights[id], id});
+}
+
+// ExtractProof, booking the steps appended as the history
+void SaturationState::ExtractHistory(int root, std::vector<ResolutionStepInfo> &history)
+{
+    size_t first = history.size();
+    ExtractProof(clauses, parents, root, history);
+
+    size_t bytes = (history.size() - first) * sizeof(ResolutionStepInfo);
+    for (size_t i = first; i < history.size(); ++i)
+    {
+        bytes += FormulaBytes(history[i].premise1) + FormulaBytes(history[i].premise2) +
+                 FormulaBytes(history[i].resolvent);
+    }
+    memory.Set(&MemoryUsage::history, bytes);
+}
+
+// the arrays hold what their capacity says, growing them is rare enough
+// to check after every change
+void SaturationState::AccountArrays()
+{
+    size_t bytes = clauses.capacity() * sizeof(Formula*) + parents.capacity() * sizeof(ClauseParents) +
+                   supported.capacity() / 8 + weights.capacity() * sizeof(int) + active.capacity() * sizeof(int);
+    memory.Set(&MemoryUsage::clauses, bytes);
+}
+
+void SaturationState::Activate(int id)
+{
+    std::vector<Formula*> literals;
+    ClauseLiterals(clauses[id], literals);
+
+    for (Formula *literal : literals)
+    {
+        bool negated = (literal->type == FormulaType::NOT);
+        Positions &positions = index[{LiteralAtom(literal)->str, negated}];
+
+        if (positions.empty() || positions.back() != (int)active.size())
+        {
+            positions.push_back(active.size());
+        }
+    }
+
+    active.push_back(id);
+    AccountArrays();
+}
+
+void SaturationState::Candidates(int given, std::vector<int> &positions)
+{
+    // a resolvent needs a complementary pair of literals with the same
+    // predicate, other active clauses are not worth unifying
+    std::vector<Formula*> literals;
+    ClauseLiterals(clauses[given], literals);
+
+    positions.clear();
+    for (Formula *literal : literals)
+    {
+        bool negated = (literal->type == FormulaType::NOT);
+        auto it = index.find({LiteralAtom(literal)->str, !negated});
+        if (it == index.end()) continue;
+
+        positions.insert(positions.end(), it->second.begin(), it->second.end());
+    }
+
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+}
+
+int SaturationState::AddInput(Formula *f, bool in_support)
+{
+    int id = clauses.size();
+
+    clauses.push_back(f);
+    parents.push_back(ClauseParents());
+    supported.push_back(in_support);
+    has_support = has_support || in_support;
+    memory.Allocate(&MemoryUsage::terms, FormulaBytes(f));
+
+    if (f->type == FormulaType::EMPTY)
+    {
+        weights.push_back(FormulaWeight(f));
+        if (refutation < 0) refutation = id;
+    }
+    else
+    {
+        AddPassive(id);
+    }
+
+    AccountArrays();
+    return id;
+}
+
+SaturationCheckpoint SaturationState::Checkpoint() const
+{
+    SaturationCheckpoint checkpoint;
+    checkpoint.clauses = clauses.size();
+    checkpoint.active  = active.size();
+    checkpoint.picks   = picks;
+    return checkpoint;
+}
+
+void SaturationState::Restore(const SaturationCheckpoint &checkpoint)
+{
+    for (size_t id = checkpoint.clauses; id < clauses.size(); ++id)
+    {
+        memory.Release(&MemoryUsage::terms, FormulaBytes(clauses[id]));
+        if (parents[id].parent1 >= 0) DeleteFormula(clauses[id]);
+    }
+
+    clauses.resize(checkpoint.clauses);
+    parents.resize(checkpoint.clauses);
+    supported.resize(checkpoint.clauses);
+    weights.resize(checkpoint.clauses);
+    active.resize(checkpoint.active);
+    picks = checkpoint.picks;
+
+    // positions are appended in order, so the newer ones are at the back
+    for (auto it = index.begin(); it != index.end(); )
+    {
+        Positions &positions = it->second;
+        while (!positions.empty() && positions.back() >= (int)active.size()) positions.pop_back();
+
+        if (positions.empty()) it = index.erase(it);
+        else                   ++it;
+    }
+
+    // every clause is either active or passive, except the empty one
+    std::vector<bool> is_active(clauses.size(), false);
+    for (int id : active) is_active[id] = true;
+
+    passive_by_age.clear();
+    passive_by_weight.clear();
+    has_support = false;
+    refutation  = -1;
+
+    for (size_t id = 0; id < clauses.size(); ++id)
+    {
+        has_support = has_support || (supported[id] && parents[id].parent1 < 0);
+
+        if (clauses[id]->type == FormulaType::EMPTY)
+        {
+            if (refutation < 0) refutation = id;
+            continue;
+        }
+
+        if (!is_active[id])
+        {
+            passive_by_age.insert(id);
+            passive_by_weight.insert({weights[id], id});
+        }
+    }
+
+    logged = std::min(logged, clauses.size());
+
+    // the proof of a restored search may be gone with its clauses
+    memory.Set(&MemoryUsage::history, 0);
+    AccountArrays();
+}
+
+void SaturationState::Export(SaturationImage &image) const
+{
+    image.clauses   = clauses;
+    image.parents   = parents;
+    image.supported = supported;
+    image.active    = active;
+    image.picks     = picks;
+    image.dropped   = dropped;
+}
+
+void SaturationState::Import(const SaturationImage &image)
+{
+    if (!clauses.empty())
+    {
+        throw std::runtime_error("Cannot import into a non-empty clause store");
+    }
+
+    clauses   = image.clauses;
+    parents   = image.parents;
+    supported = image.supported;
+    dropped   = image.dropped;
+
+    for (Formula *f : clauses)
+    {
+        weights.push_back(FormulaWeight(f));
+        memory.Allocate(&MemoryUsage::terms, FormulaBytes(f));
+    }
+    for (int id : image.active) Activate(id);
+
+    // rebuilds the passive queues and the counters from the clauses
+    SaturationCheckpoint checkpoint;
+    checkpoint.clauses = clauses.size();
+    checkpoint.active  = active.size();
+    checkpoint.picks   = image.picks;
+    Restore(checkpoint);
+}
+
+ProofResult SaturationState::Run(const ResolutionOptions &options, std::vector<ResolutionStepInfo> &history)
+{
+    // given clause loop: every clause taken from passive is resolved against
+    // the active clauses and becomes active itself
+    RZLOGIC_TRACE_SCOPE("saturate");
+    const ResolutionLimits &limits = options.limits;
+    size_t generated = 0;
+
+    if (options.log)
+    {
+        for (; logged < clauses.size(); ++logged)
+        {
+            options.log->Append(logged, parents[logged].parent1, parents[logged].parent2,
+                                parents[logged].parent1 < 0 ? InferenceRule::INPUT : InferenceRule::RESOLUTION,
+                                clauses[logged]);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    size_t kept = 0;
+    std::vector<int> units; // derived since the last report
+
+    auto report = [&]()
+    {
+        ProgressInfo info;
+        info.seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        info.generated = generated;
+        info.kept      = kept;
+        info.clauses   = clauses.size();
+        info.active    = active.size();
+        info.passive   = passive_by_age.size();
+        info.memory    = memory.Live().Total();
+        for (int id : units) info.units.push_back(clauses[id]);
+
+        options.progress(info);
+
+        units.clear();
+        last_report = std::chrono::steady_clock::now();
+    };
+
+    // statistics of this run, the allocations of the generation tasks are
+    // counted on their threads and the rest on this one
+    ProofStatistics counted;
+    size_t allocations_mark = FormulaAllocations();
+
+    auto record = [&]()
+    {
+        if (!options.statistics) return;
+
+        counted.resolution_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        counted.generated          = generated;
+        counted.kept               = kept;
+        counted.peak_clauses       = clauses.size();
+        counted.term_allocations  += FormulaAllocations() - allocations_mark;
+        counted.peak_memory        = memory.PeakTotal();
+        counted.peak_usage         = memory.Peak();
+        options.statistics->Add(counted);
+    };
+
+    // the steps handed out before are the caller's now
+    memory.Set(&MemoryUsage::history, 0);
+
+    if (refutation >= 0)
+    {
+        ExtractHistory(refutation, history);
+        if (options.progress) report();
+        record();
+        return ProofResult::PROVED;
+    }
+
+    // nothing to support: fall back to unrestricted resolution
+    bool restricted = options.set_of_support && has_support;
+
+    std::unique_ptr<ThreadPool> pool;
+    if (options.threads > 1)
+    {
+        pool = std::make_unique<ThreadPool>(options.threads);
+    }
+
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(limits.max_seconds));
+
+    // cheap enough for the inner loops: an atomic load and a clock read
+    auto stopped = [&]()
+    {
+        return options.cancel.IsCancelled() ||
+               (limits.max_seconds > 0 && std::chrono::steady_clock::now() > deadline);
+    };
+
+    auto over_budget = [&]()
+    {
+        return (limits.max_generated > 0 && generated >= limits.max_generated) ||
+               (limits.max_memory > 0 && memory.Live().Total() >= limits.max_memory);
+    };
+
+    // what a generation task did, kept only for statistics
+    struct Generation
+    {
+        bool   attempted   = false;
+        bool   unified     = false;
+        size_t allocations = 0;
+    };
+
+    std::vector<int>        candidates;
+    std::vector<Formula*>   resolvents;
+    std::vector<Generation> generations;
+    ProofResult result = ProofResult::SATURATED;
+
+    while (result == ProofResult::SATURATED && !passive_by_age.empty())
+    {
+        if (options.poll) options.poll();
+
+        if (options.progress && std::chrono::duration<double>(std::chrono::steady_clock::now() - last_report).count()
+                                    >= options.progress_interval)
+        {
+            report();
+        }
+
+        if (stopped() || over_budget())
+        {
+            result = ProofResult::UNKNOWN;
+            break;
+        }
+
+        int given;
+        if (options.weight_ratio > 0 && picks++ % (options.weight_ratio + 1) != 0)
+        {
+            given = passive_by_weight.begin()->second;
+        }
+        else
+        {
+            given = *passive_by_age.begin();
+        }
+
+        passive_by_age.erase(given);
+        passive_by_weight.erase({weights[given], given});
+
+        // the rest of the slice after generate is spent on the redundancy checks
+        RZLOGIC_TRACE_SCOPE("given clause");
+
+        Candidates(given, candidates);
+        resolvents.assign(candidates.size(), nullptr);
+        if (options.statistics)
+        {
+            generations.assign(candidates.size(), Generation());
+            counted.index_hits       += candidates.size();
+            counted.term_allocations += FormulaAllocations() - allocations_mark;
+        }
+
+        auto generate = [&](size_t k)
+        {
+            int partner = active[candidates[k]];
+
+            if (restricted && !supported[partner] && !supported[given]) return;
+            if (stopped()) return;
+
+            if (!options.statistics)
+            {
+                resolvents[k] = MakeResolvent(clauses[partner], clauses[given], options.ordered);
+                return;
+            }
+
+            Generation &generation = generations[k];
+            size_t before = FormulaAllocations();
+
+            generation.attempted   = true;
+            resolvents[k]          = MakeResolvent(clauses[partner], clauses[given], options.ordered, &generation.unified);
+            generation.allocations = FormulaAllocations() - before;
+        };
+
+        {
+            RZLOGIC_TRACE_SCOPE("generate");
+            if (pool) pool->ParallelFor(candidates.size(), generate);
+            else      for (size_t k = 0; k < candidates.size(); ++k) generate(k);
+        }
+
+        if (options.statistics)
+        {
+            for (const Generation &generation : generations)
+            {
+                counted.unification_attempts  += generation.attempted;
+                counted.unification_successes += generation.unified;
+                counted.term_allocations      += generation.allocations;
+            }
+            allocations_mark = FormulaAllocations();
+        }
+
+        // merge in active order, so the outcome does not depend on the threads
+        for (size_t k = 0; k < resolvents.size(); ++k)
+        {
+            Formula *res = resolvents[k];
+            if (!res) continue;
+
+            if (result != ProofResult::SATURATED)
+            {
+                DeleteFormula(res);
+                continue;
+            }
+
+            int partner = active[candidates[k]];
+            generated++;
+
+            if (res->type != FormulaType::EMPTY && IsTautology(res))
+            {
+                counted.tautologies++;
+                DeleteFormula(res);
+                continue;
+            }
+
+            if (res->type != FormulaType::EMPTY && IsRedundant(res, clauses))
+            {
+                counted.subsumed++;
+                DeleteFormula(res);
+                continue;
+            }
+
+            if (limits.max_term_depth > 0 && TermDepth(res) > limits.max_term_depth)
+            {
+                // the clause set is no longer complete, saturation proves nothing
+                dropped = true;
+                DeleteFormula(res);
+                continue;
+            }
+
+            int id = clauses.size();
+            clauses.push_back(res);
+            parents.push_back({partner, given});
+            supported.push_back(supported[partner] || supported[given]);
+            memory.Allocate(&MemoryUsage::terms, FormulaBytes(res));
+            kept++;
+
+            if (options.progress && (res->type == FormulaType::PREDICATE || res->type == FormulaType::NOT
+                                     || res->type == FormulaType::EMPTY))
+            {
+                units.push_back(id);
+            }
+
+            if (options.log)
+            {
+                options.log->Append(id, partner, given, InferenceRule::RESOLUTION, res);
+                logged = clauses.size();
+            }
+
+            if (res->type == FormulaType::EMPTY)
+            {
+                weights.push_back(FormulaWeight(res));
+                refutation = id;
+                result = ProofResult::PROVED;
+                ExtractHistory(id, history);
+                continue;
+            }
+
+            AddPassive(id);
+            AccountArrays();
+
+            if (over_budget())
+            {
+                result = ProofResult::UNKNOWN;
+            }
+        }
+
+        // inferences skipped by a cancelled generation are lost
+        if (result == ProofResult::SATURATED && stopped())
+        {
+            result = ProofResult::UNKNOWN;
+        }
+
+        if (result == ProofResult::UNKNOWN)
+        {
+            // not all of its inferences were kept, a later run redoes them
+            passive_by_age.insert(given);
+            passive_by_weight.insert({weights[given], given});
+        }
+        else
+        {
+            Activate(given);
+        }
+
+        RZLOGIC_TRACE_COUNTER("clauses", clauses.size());
+        RZLOGIC_TRACE_COUNTER("passive", passive_by_age.size());
+        RZLOGIC_TRACE_COUNTER("subsumed", counted.subsumed);
+        RZLOGIC_TRACE_COUNTER("tautologies", counted.tautologies);
+    }
+
+    if (result == ProofResult::SATURATED && dropped)
+    {
+        result = ProofResult::UNKNOWN;
+    }
+
+    if (options.progress) report();
+    record();
+
+    return result;
+}
+
+ProofResult MakeResolution(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history, const ResolutionOptions &options)
+{
+    SaturationState state;
+
+    for (Formula *premise : premises)
+    {
+        state.AddInput(premise, IsNegativeClause(premise));
+    }
+
+    return state.Run(options, history);
+}
+
+bool MakeResolution(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history)
+{
+    return MakeResolution(premises, history, ResolutionOptions()) == ProofResult::PROVED;
+}
+
+std::vector<ResolutionOptions> PortfolioStrategies(int count, const ResolutionOptions &base)
+{
+    struct Preset
+    {
+        int  weight_ratio;
+        bool set_of_support;
+        bool ordered;
+    };
+
+    // the first one is plain complete resolution, the rest trade
+    // completeness for speed on different kinds of problems
+    static const Preset presets[] = {
+        {0, false, false},
+        {4, false, false},
+        {2, true,  false},
+        {0, false, true },
+        {4, false, true },
+        {0, true,  false},
+        {1, false, false},
+        {4, true,  true },
+    };
+    const int presets_count = sizeof(presets) / sizeof(presets[0]);
+
+    std::vector<ResolutionOptions> strategies;
+    for (int i = 0; i < count; ++i)
+    {
+        ResolutionOptions options = base;
+
+        if (i < presets_count)
+        {
+            options.weight_ratio   = presets[i].weight_ratio;
+            options.set_of_support = presets[i].set_of_support;
+            options.ordered        = presets[i].ordered;
+        }
+        else
+        {
+            options.weight_ratio   = i;
+            options.set_of_support = (i % 2 == 1);
+            options.ordered        = false;
+        }
+
+        strategies.push_back(options);
+    }
+
+    return strategies;
+}
+
+ProofResult MakeResolutionPortfolio(std::vector<Formula*> &premises, std::vector<ResolutionStepInfo> &history, int threads,
+                                    const ResolutionOptions &options)
+{
+    std::vector<ResolutionOptions> strategies = PortfolioStrategies(std::max(threads, 1), options);
+    std::vector<std::vector<ResolutionStepInfo>> histories(strategies.size());
+    std::vector<ProofResult> results(strategies.size(), ProofResult::UNKNOWN);
+    std::vector<ProofStatistics> statistics(strategies.size());
+    std::vector<std::thread> runners;
+
+    // the premises are only read by the strategies, so they are shared.
+    // The winner cancels the others through a child of the caller's token.
+    CancellationToken race = options.cancel.Child();
+    std::mutex              mutex;
+    std::condition_variable finished;
+    int running = strategies.size();
+    int winner  = -1;
+
+    for (size_t i = 0; i < strategies.size(); ++i)
+    {
+        strategies[i].threads = 1;
+        strategies[i].cancel  = race;
+        strategies[i].poll    = nullptr;
+        strategies[i].log     = nullptr;
+        if (options.statistics) strategies[i].statistics = &statistics[i];
+
+        // the complete strategy speaks for the portfolio
+        if (i > 0) strategies[i].progress = nullptr;
+
+        runners.emplace_back([&, i]
+        {
+            results[i] = MakeResolution(premises, histories[i], strategies[i]);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (results[i] == ProofResult::PROVED && winner < 0)
+            {
+                winner = int(i);
+                race.Cancel();
+            }
+
+            // the complete strategy saturating is the answer, nothing to wait for
+            if (i == 0 && results[i] == ProofResult::SATURATED) race.Cancel();
+            running--;
+            finished.notify_all();
+        });
+    }
+
+    // the caller's poll runs here, on the thread that called us
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running > 0)
+        {
+            if (options.poll)
+            {
+                lock.unlock();
+                options.poll();
+                lock.lock();
+            }
+            finished.wait_for(lock, std::chrono::milliseconds(10), [&running] { return running == 0; });
+        }
+    }
+
+    for (std::thread &runner : runners)
+    {
+        runner.join();
+    }
+
+    // without a refutation only the complete first strategy can tell
+    // saturation from giving up
+    size_t chosen = (winner >= 0) ? winner : 0;
+
+    // like the log, the statistics are the ones of the chosen strategy
+    if (options.statistics) options.statistics->Add(statistics[chosen]);
+
+    // racing strategies would interleave their ids, so only the winning
+    // proof is logged
+    if (options.log)
+    {
+        for (size_t i = 0; i < premises.size(); ++i)
+        {
+            options.log->Append(i, -1, -1, InferenceRule::INPUT, premises[i]);
+        }
+
+        for (ResolutionStepInfo &step : histories[chosen])
+        {
+            options.log->Append(step.resolvent_id, step.premise1_id, step.premise2_id,
+                                InferenceRule::RESOLUTION, step.resolvent);
+        }
+    }
+
+    for (size_t i = 0; i < histories.size(); ++i)
+    {
+        if (i == chosen)
+        {
+            history.insert(history.end(), histories[i].begin(), histories[i].end());
+        }
+        else
+        {
+            DeleteHistory(histories[i]);
+        }
+    }
+
+    return results[chosen];
+}
 } // namespace rzlogic
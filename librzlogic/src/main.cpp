@@ -1,13 +1,337 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
-#include <vector>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "generators.hpp"
 #include "logic.hpp"
-#include "../tests/utils.hpp"
-#include "parser.hpp"
+#include "prover.hpp"
+#include "thread_pool.hpp"
+#include "tptp.hpp"
+#include "trace.hpp"
+
+using namespace rzlogic;
+
+static const char USAGE[] =
+    "usage: rzprove [options] PATH...\n"
+    "\n"
+    "Proves every problem file, premises separated by white space, or every\n"
+    "file under a directory, and prints one row per problem in the order of\n"
+    "the input. # starts a comment up to the end of the line.\n"
+    "\n"
+    "      --tptp              the files are TPTP problems, directories are\n"
+    "                          searched for .p files\n"
+    "  -I, --include DIR       TPTP root the includes are looked up in\n"
+    "  -j, --jobs N            problems proved at once (default: one per core)\n"
+    "  -t, --timeout S         wall time budget of every problem\n"
+    "  -m, --max-memory BYTES  budget of bytes held by the search of every problem\n"
+    "      --max-clauses N     budget of generated clauses of every problem\n"
+    "  -g, --generate F:N      add the generated problem of family F and size N\n"
+    "  -f, --format csv|json   csv rows or JSON lines (default csv), memory is\n"
+    "                          the peak of bytes held by the search\n"
+    "      --trace FILE        write a Chrome trace of the run to FILE, needs a\n"
+    "                          build with RZLOGIC_TRACING\n";
+
+struct CliProblem
+{
+    std::string              name;
+    std::vector<std::string> premises; // of a generated problem
+    std::string              path;     // of a file, read when it is proved
+    bool                     tptp = false;
+};
+
+struct CliResult
+{
+    std::string status;
+    double      seconds   = 0;
+    size_t      generated = 0;
+    size_t      kept      = 0;
+    size_t      memory    = 0;
+    std::string error;
+};
+
+static void AddPath(const std::string &path, bool tptp, std::vector<CliProblem> &problems)
+{
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> files;
+    if (fs::is_directory(path))
+    {
+        for (const auto &entry : fs::recursive_directory_iterator(path)) {
+            if (!entry.is_regular_file() || (tptp && entry.path().extension() != ".p")) continue;
+            files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    }
+    else
+    {
+        files.push_back(path);
+    }
+
+    for (const std::string &file : files)
+    {
+        CliProblem problem;
+        problem.name = file;
+        problem.path = file;
+        problem.tptp = tptp;
+        problems.push_back(problem);
+    }
+}
+
+static CliResult Prove(const CliProblem &problem, const ResolutionLimits &limits, const std::string &include_dir)
+{
+    CliResult result;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Formula*> clauses;
+    std::vector<ResolutionStepInfo> history;
+
+    try
+    {
+        if (problem.tptp)
+        {
+            std::vector<Formula*> formulas;
+            ReadTptpProblem(problem.path, formulas, include_dir);
+            ClausifyFormulas(formulas, clauses);
+        }
+        else if (!problem.path.empty())
+        {
+            ClausifyPremiseFile(problem.path, clauses);
+        }
+        else
+        {
+            ClausifyPremises(problem.premises, clauses);
+        }
+
+        ProofStatistics statistics;
+        ResolutionOptions options;
+        options.limits     = limits;
+        options.statistics = &statistics;
+
+        switch (MakeResolution(clauses, history, options)) {
+        case ProofResult::PROVED:    result.status = "proved"; break;
+        case ProofResult::SATURATED: result.status = "saturated"; break;
+        case ProofResult::UNKNOWN:   result.status = "unknown"; break;
+        }
+
+        // the memory left at the end is little more than the proof, the
+        // peak is what a budget has to allow
+        result.generated = statistics.generated;
+        result.kept      = statistics.kept;
+        result.memory    = statistics.peak_memory;
+    }
+    catch (const std::exception &e)
+    {
+        result.status = "error";
+        result.error  = e.what();
+    }
+
+    DeleteHistory(history);
+    for (Formula *f : clauses) DeleteFormula(f);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static std::string CsvField(const std::string &str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos) return str;
+
+    std::string quoted = "\"";
+    for (char c : str)
+    {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static std::string JsonString(const std::string &str)
+{
+    std::string quoted = "\"";
+    for (unsigned char c : str)
+    {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+static std::string FormatRow(const CliProblem &problem, const CliResult &result, bool json)
+{
+    char seconds[32];
+    snprintf(seconds, sizeof(seconds), "%.6f", result.seconds);
+
+    if (json)
+    {
+        return "{\"problem\": " + JsonString(problem.name) +
+               ", \"status\": \"" + result.status + "\"" +
+               ", \"seconds\": " + seconds +
+               ", \"generated\": " + std::to_string(result.generated) +
+               ", \"kept\": " + std::to_string(result.kept) +
+               ", \"memory\": " + std::to_string(result.memory) +
+               ", \"error\": " + JsonString(result.error) + "}\n";
+    }
+
+    return CsvField(problem.name) + "," + result.status + "," + seconds + "," +
+           std::to_string(result.generated) + "," + std::to_string(result.kept) + "," +
+           std::to_string(result.memory) + "," + CsvField(result.error) + "\n";
+}
+
+static bool ParseCount(const char *value, double &number)
+{
+    char *end;
+    number = strtod(value, &end);
+    return *value != '\0' && *end == '\0' && number >= 0;
+}
 
 int main(int argc, char* argv[])
 {
-    
-    
-    return 0;
-}
\ No newline at end of file
+    std::vector<CliProblem> problems;
+    ResolutionLimits limits;
+    std::string include_dir;
+    std::string trace;
+    size_t jobs = 0;
+    bool json = false;
+    bool tptp = false;
+
+    // --tptp applies to all paths, also to the ones before it
+    for (int i = 1; i < argc; i++) tptp = tptp || std::string(argv[i]) == "--tptp";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        double number = 0;
+
+        if (arg == "-h" || arg == "--help")
+        {
+            std::cout << USAGE;
+            return 0;
+        }
+        else if ((arg == "-j" || arg == "--jobs") && has_value && ParseCount(argv[++i], number)) {
+            jobs = number;
+        }
+        else if ((arg == "-t" || arg == "--timeout") && has_value && ParseCount(argv[++i], number)) {
+            limits.max_seconds = number;
+        }
+        else if ((arg == "-m" || arg == "--max-memory") && has_value && ParseCount(argv[++i], number)) {
+            limits.max_memory = number;
+        }
+        else if (arg == "--max-clauses" && has_value && ParseCount(argv[++i], number)) {
+            limits.max_generated = number;
+        }
+        else if ((arg == "-f" || arg == "--format") && has_value) {
+            std::string format = argv[++i];
+            if (format != "csv" && format != "json") {
+                std::cerr << USAGE;
+                return 2;
+            }
+            json = (format == "json");
+        }
+        else if ((arg == "-g" || arg == "--generate") && has_value) {
+            std::string spec = argv[++i];
+            size_t colon = spec.find(':');
+
+            try
+            {
+                if (colon == std::string::npos) throw std::runtime_error("expected FAMILY:SIZE, got " + spec);
+                GeneratedProblem generated = GenerateProblem(spec.substr(0, colon), std::atoi(spec.c_str() + colon + 1));
+
+                CliProblem problem;
+                problem.name     = generated.name;
+                problem.premises = generated.premises;
+                problems.push_back(problem);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "rzprove: " << e.what() << "\n";
+                return 2;
+            }
+        }
+        else if (arg == "--tptp") {
+            continue; // taken above
+        }
+        else if ((arg == "-I" || arg == "--include") && has_value) {
+            include_dir = argv[++i];
+        }
+        else if (arg == "--trace" && has_value) {
+            if (!TracingAvailable())
+            {
+                std::cerr << "rzprove: --trace needs a build with RZLOGIC_TRACING\n";
+                return 2;
+            }
+            trace = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            AddPath(arg, tptp, problems);
+        }
+        else {
+            std::cerr << USAGE;
+            return 2;
+        }
+    }
+
+    if (problems.empty())
+    {
+        std::cerr << USAGE;
+        return 2;
+    }
+
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << (json ? "" : "problem,status,seconds,generated,kept,memory,error\n");
+
+    // rows are printed in input order as soon as all before them are done
+    std::vector<CliResult> results(problems.size());
+    std::vector<bool>      done(problems.size(), false);
+    size_t                 printed = 0;
+    bool                   failed  = false;
+    std::mutex             mutex;
+
+    if (!trace.empty()) StartTracing();
+
+    ThreadPool pool(jobs);
+    pool.ParallelFor(problems.size(), [&](size_t i)
+    {
+        CliResult result = Prove(problems[i], limits, include_dir);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results[i] = result;
+        done[i]    = true;
+        failed     = failed || result.status == "error";
+
+        for (; printed < problems.size() && done[printed]; printed++) {
+            std::cout << FormatRow(problems[printed], results[printed], json) << std::flush;
+        }
+    });
+
+    if (!trace.empty())
+    {
+        StopTracing();
+        try {
+            WriteTrace(trace);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "rzprove: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -1,84 +1,77 @@
 #include "parser.hpp"
+#include "snapshot.hpp"
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 
 namespace rzlogic {
 
 Formula *Parser::ParseTerm()
 {
-    if (token_type == TokenType::IDENTIFIER) {
+    if (token.type == TokenType::IDENTIFIER) {
         Formula *f = new Formula();
-        f->str = token_str;
-        f->type = (token_str.size() >= 1 && tolower(token_str[0]) >= 'n') ? FormulaType::VARIABLE
-                                                                          : FormulaType::CONSTANT;
+        f->str = token.text;
+        f->type = (tolower(token.text[0]) >= 'n') ? FormulaType::VARIABLE : FormulaType::CONSTANT;
 
         ParseToken();
         return f;
     }
-    else if (token_type == TokenType::LPAREN)
+    else if (token.type == TokenType::LPAREN)
     {
         Formula *f = new Formula();
         f->type = FormulaType::FUNCTION;
         
         ParseToken();
-        if (token_type != TokenType::IDENTIFIER) {
+        if (token.type != TokenType::IDENTIFIER) {
             throw std::runtime_error("Expected function name");
         }
-        f->str = token_str;
+        f->str = token.text;
         ParseToken();
 
-        while (token_type != TokenType::RPAREN) {
+        while (token.type != TokenType::RPAREN) {
             f->children.push_back(ParseTerm());
         }
         ParseToken();
         return f;
     }
 
-    throw std::runtime_error("Expected identifier or '(' at position " + std::to_string(cur_char - input.data()));
+    throw std::runtime_error("Expected identifier or '(' at position " + std::to_string(token.text.data() - input.data()));
 }
 
 void Parser::ParseToken()
 {
-    token_str.clear();
-    while (*cur_char == ' ') cur_char++;
-
-    switch (*cur_char) {
-    case '(': token_type = TokenType::LPAREN; cur_char++; return;
-    case ')': token_type = TokenType::RPAREN; cur_char++; return;
-    case '\0': token_type = TokenType::END; return;
-        return;
+    token = tokenizer.Next();
+    if (token.type == TokenType::INVALID) {
+        throw std::runtime_error(std::string("Unexpected character '") + token.text[0] + "' at position " +
+                                 std::to_string(token.text.data() - input.data()));
     }
-
-    char *start = cur_char;
-    while (isalnum(*cur_char)) cur_char++;
-    token_str = std::string(start, cur_char - start);
-    token_type = TokenType::IDENTIFIER;
 }
 
 Formula *Parser::ParseFormula()
 {
-    if (token_type == TokenType::LPAREN)
+    if (token.type == TokenType::LPAREN)
     {
         ParseToken();
-        if (token_type != TokenType::IDENTIFIER) {
-            throw std::runtime_error("Expected identifier at position " + std::to_string(cur_char - input.data()));
+        if (token.type != TokenType::IDENTIFIER) {
+            throw std::runtime_error("Expected identifier at position " + std::to_string(token.text.data() - input.data()));
         }
-        std::string name = token_str;
+        std::string name(token.text);
         ParseToken();
 
         if (name == "forall" || name == "exists")
         {
             Formula *f = new Formula();
-            if (token_type != TokenType::IDENTIFIER) {
+            if (token.type != TokenType::IDENTIFIER) {
                 throw std::runtime_error("Expected variable name after quantifier");
             }
-            std::string var_name = token_str;
+            std::string var_name(token.text);
             ParseToken();
 
             f->type = (name == "forall") ? FormulaType::FORALL : FormulaType::EXISTS;
             f->children.push_back(ParseFormula());
             f->str = var_name;
             
-            if (token_type != TokenType::RPAREN) {
+            if (token.type != TokenType::RPAREN) {
                 throw std::runtime_error("Expected ')' after quantifier");
             }
             ParseToken();
@@ -90,7 +83,7 @@ Formula *Parser::ParseFormula()
             f->type = FormulaType::NOT;
             f->children.push_back(ParseFormula());
             
-            if (token_type != TokenType::RPAREN) {
+            if (token.type != TokenType::RPAREN) {
                 throw std::runtime_error("Expected ')' after not");
             }
             ParseToken();
@@ -103,7 +96,7 @@ Formula *Parser::ParseFormula()
             f->children.push_back(ParseFormula());
             f->children.push_back(ParseFormula());
             
-            if (token_type != TokenType::RPAREN) {
+            if (token.type != TokenType::RPAREN) {
                 throw std::runtime_error("Expected ')' after implies");
             }
             ParseToken();
@@ -116,7 +109,7 @@ Formula *Parser::ParseFormula()
             f->children.push_back(ParseFormula());
             f->children.push_back(ParseFormula());
             
-            if (token_type != TokenType::RPAREN) {
+            if (token.type != TokenType::RPAREN) {
                 throw std::runtime_error("Expected ')' after binary operator");
             }
             ParseToken();
@@ -128,7 +121,7 @@ Formula *Parser::ParseFormula()
             f->type = FormulaType::PREDICATE;
             f->str = name;
 
-            while (token_type != TokenType::RPAREN) {
+            while (token.type != TokenType::RPAREN) {
                 f->children.push_back(ParseTerm());
             }
             
@@ -137,7 +130,7 @@ Formula *Parser::ParseFormula()
         }
     }
     else {
-        throw std::runtime_error("Expected '(' at position " + std::to_string(cur_char - input.data()));
+        throw std::runtime_error("Expected '(' at position " + std::to_string(token.text.data() - input.data()));
     }
 }
 
@@ -145,11 +138,190 @@ Formula *Parser::Parse()
 {
     ParseToken();
     Formula *result = ParseFormula();
-    if (token_type != TokenType::END) {
+    if (token.type != TokenType::END) {
         throw std::runtime_error("Unexpected trailing characters");
     }
 
     return result;
 }
 
-} // namespace rzlogic
\ No newline at end of file
+StreamParser::StreamParser(const std::string &path)
+    : file(new MappedFile(path)), name(path), size(file->Size()), tokenizer(file->Data(), size, true)
+{
+}
+
+StreamParser::StreamParser(const char *data, size_t size, const std::string &name)
+    : name(name), size(size), tokenizer(data, size, true)
+{
+}
+
+StreamParser::~StreamParser() = default;
+
+void StreamParser::Error(const std::string &message) const
+{
+    // errors are rare, the position is only counted out here
+    const char *start = tokenizer.Data();
+    const char *at    = token.text.data();
+
+    size_t      line       = 1 + std::count(start, at, '\n');
+    const char *line_start = at;
+    while (line_start > start && line_start[-1] != '\n') line_start--;
+
+    throw std::runtime_error(name + ":" + std::to_string(line) + ":" + std::to_string(at - line_start + 1) + ": " +
+                             message);
+}
+
+void StreamParser::ParseToken()
+{
+    token = tokenizer.Next();
+    if (token.type == TokenType::INVALID) Error(std::string("Unexpected character '") + token.text[0] + "'");
+}
+
+void StreamParser::ResizeInterned(size_t slots)
+{
+    // the slots move without hashing the names again
+    std::vector<InternSlot> old(slots);
+    old.swap(interned);
+
+    size_t mask = interned.size() - 1;
+    for (const InternSlot &slot : old)
+    {
+        if (!slot.name) continue;
+
+        size_t i = slot.hash & mask;
+        while (interned[i].name) i = (i + 1) & mask;
+        interned[i] = slot;
+    }
+}
+
+bool StreamParser::Intern(std::string_view name)
+{
+    // at most half full
+    if (2 * (names.size() + 1) > interned.size()) {
+        ResizeInterned(std::max<size_t>(64, 2 * interned.size()));
+    }
+
+    uint32_t hash = std::hash<std::string_view>()(name);
+    size_t   mask = interned.size() - 1;
+
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        InternSlot &slot = interned[i];
+        if (!slot.name)
+        {
+            names.push_back(name);
+            slot.hash = hash;
+            slot.name = names.size();
+            return true;
+        }
+        if (slot.hash == hash && names[slot.name - 1] == name) return false;
+    }
+}
+
+SymbolTable &StreamParser::Symbols()
+{
+    for (; names_in_table < names.size(); names_in_table++) {
+        symbols.Insert(std::string(names[names_in_table]));
+    }
+    return symbols;
+}
+
+Formula *StreamParser::Symbol(FormulaType type)
+{
+    if (type != FormulaType::VARIABLE) Intern(token.text);
+
+    Formula *f = new Formula(type);
+    f->str.assign(token.text.data(), token.text.size());
+    return f;
+}
+
+Formula *StreamParser::ParseTerm()
+{
+    if (token.type == TokenType::IDENTIFIER)
+    {
+        FormulaPtr f(Symbol(tolower(token.text[0]) >= 'n' ? FormulaType::VARIABLE : FormulaType::CONSTANT));
+        ParseToken();
+        return f.release();
+    }
+    if (token.type != TokenType::LPAREN) Error("Expected identifier or '('");
+
+    ParseToken();
+    if (token.type != TokenType::IDENTIFIER) Error("Expected function name");
+
+    FormulaPtr f(Symbol(FormulaType::FUNCTION));
+    ParseToken();
+
+    while (token.type != TokenType::RPAREN) {
+        f->children.push_back(ParseTerm());
+    }
+    ParseToken();
+    return f.release();
+}
+
+Formula *StreamParser::ParseFormula()
+{
+    if (token.type != TokenType::LPAREN) Error("Expected '('");
+
+    ParseToken();
+    if (token.type != TokenType::IDENTIFIER) Error("Expected identifier");
+
+    std::string_view op = token.text;
+    FormulaPtr f;
+    int operands = 0;
+
+    if (op == "forall" || op == "exists")
+    {
+        ParseToken();
+        if (token.type != TokenType::IDENTIFIER) Error("Expected variable name after quantifier");
+
+        f.reset(new Formula(op == "forall" ? FormulaType::FORALL : FormulaType::EXISTS));
+        f->str.assign(token.text.data(), token.text.size());
+        operands = 1;
+    }
+    else if (op == "not") {
+        f.reset(new Formula(FormulaType::NOT));
+        operands = 1;
+    }
+    else if (op == "implies" || op == "or" || op == "and") {
+        f.reset(new Formula(op == "implies" ? FormulaType::IMPLIES : op == "or" ? FormulaType::OR : FormulaType::AND));
+        operands = 2;
+    }
+    else
+    {
+        f.reset(Symbol(FormulaType::PREDICATE));
+        ParseToken();
+
+        while (token.type != TokenType::RPAREN) {
+            f->children.push_back(ParseTerm());
+        }
+        ParseToken();
+        return f.release();
+    }
+
+    ParseToken();
+    for (int i = 0; i < operands; i++) {
+        f->children.push_back(ParseFormula());
+    }
+
+    if (token.type != TokenType::RPAREN) Error("Expected ')' after " + std::string(op));
+    ParseToken();
+    return f.release();
+}
+
+void StreamParser::Parse(const std::function<void(Formula*)> &consumer)
+{
+    // Fact bases have about a new name every 8 bytes. Growing the table on
+    // the way costs more than a guess, which is capped for huge files.
+    size_t expected = std::min<size_t>(size / 8, 1 << 20);
+    size_t slots = 64;
+    while (slots < 2 * expected) slots *= 2;
+
+    if (slots > interned.size()) ResizeInterned(slots);
+    names.reserve(expected);
+
+    for (ParseToken(); token.type != TokenType::END; ) {
+        consumer(ParseFormula());
+    }
+}
+
+} // namespace rzlogic
@@ -0,0 +1,419 @@
+#include "proof_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace rzlogic {
+
+static const char CACHE_ENTRY_HEADER[] = "RZPC 1";
+
+void CanonicalClause(Formula *f, std::map<std::string, int> &variables, std::string &out)
+{
+    if (f->type == FormulaType::VARIABLE)
+    {
+        auto it = variables.emplace(f->str, variables.size()).first;
+        out += "_" + std::to_string(it->second);
+        return;
+    }
+
+    if (f->type == FormulaType::EMPTY)
+    {
+        out += "□";
+        return;
+    }
+
+    if (f->children.empty())
+    {
+        out += f->str;
+        return;
+    }
+
+    out += "(";
+    switch (f->type) {
+    case FormulaType::NOT:
+    case FormulaType::AND:
+    case FormulaType::OR:
+    case FormulaType::IMPLIES:
+        out += GetFormulaTypeStr(f->type);
+        break;
+    default:
+        out += f->str;
+        break;
+    }
+
+    for (Formula *child : f->children)
+    {
+        out += " ";
+        CanonicalClause(child, variables, out);
+    }
+    out += ")";
+}
+
+std::string CanonicalProblemKey(const std::vector<Formula*> &clauses)
+{
+    std::vector<std::string> texts;
+
+    for (Formula *f : clauses)
+    {
+        std::map<std::string, int> variables;
+        std::string text;
+        CanonicalClause(f, variables, text);
+        texts.push_back(text);
+    }
+
+    std::sort(texts.begin(), texts.end());
+
+    std::string key;
+    for (const std::string &text : texts)
+    {
+        key += text;
+        key += '\n';
+    }
+    return key;
+}
+
+static bool IsNumberedName(const std::string &name)
+{
+    return name.size() > 1 && name[0] == '_' && name.find_first_not_of("0123456789", 1) == std::string::npos;
+}
+
+static void CheckSymbols(Formula *f, ProblemVariables &variables)
+{
+    if (f->type != FormulaType::VARIABLE && IsNumberedName(f->str)) variables.renamable = false;
+    for (Formula *child : f->children) CheckSymbols(child, variables);
+}
+
+void NumberProblemVariables(const std::vector<Formula*> &clauses, ProblemVariables &variables)
+{
+    // the clause variables in the order CanonicalClause numbers them
+    std::vector<std::pair<std::string, std::vector<std::string>>> texts;
+
+    for (Formula *f : clauses)
+    {
+        std::map<std::string, int> numbers;
+        std::string text;
+        CanonicalClause(f, numbers, text);
+        CheckSymbols(f, variables);
+
+        std::vector<std::string> names(numbers.size());
+        for (auto &entry : numbers) names[entry.second] = entry.first;
+        texts.emplace_back(std::move(text), std::move(names));
+    }
+
+    std::stable_sort(texts.begin(), texts.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    std::map<std::string, size_t> numbers;
+    for (size_t i = 0; i < variables.names.size(); i++) numbers[variables.names[i]] = i;
+
+    variables.pattern += "variables";
+    for (auto &text : texts)
+    {
+        for (const std::string &name : text.second)
+        {
+            auto it = numbers.emplace(name, variables.names.size()).first;
+            if (it->second == variables.names.size()) variables.names.push_back(name);
+            variables.pattern += " " + std::to_string(it->second);
+        }
+        variables.pattern += ";";
+    }
+    variables.pattern += "\n";
+}
+
+static bool NumberVariables(Formula *f, const std::map<std::string, size_t> &numbers)
+{
+    if (f->type == FormulaType::VARIABLE)
+    {
+        auto it = numbers.find(f->str);
+        if (it == numbers.end()) return false;
+
+        f->str = "_" + std::to_string(it->second);
+        return true;
+    }
+
+    for (Formula *child : f->children) {
+        if (!NumberVariables(child, numbers)) return false;
+    }
+    return true;
+}
+
+static bool CanonicalString(Formula *f, const std::map<std::string, size_t> &numbers, std::string &out)
+{
+    FormulaPtr clone(CloneFormula(f));
+    if (!NumberVariables(clone.get(), numbers)) return false;
+
+    out = FormulaAsString(clone.get());
+    return true;
+}
+
+bool CanonicalProofSteps(const std::vector<ResolutionStepInfo> &history, const ProblemVariables &variables,
+                         std::vector<ProofStepStrings> &steps)
+{
+    std::map<std::string, size_t> numbers;
+    for (size_t i = 0; i < variables.names.size(); i++) numbers[variables.names[i]] = i;
+
+    steps.clear();
+    for (const ResolutionStepInfo &step : history)
+    {
+        std::string premise1, premise2, resolvent;
+        if (!CanonicalString(step.premise1, numbers, premise1) ||
+            !CanonicalString(step.premise2, numbers, premise2) ||
+            !CanonicalString(step.resolvent, numbers, resolvent)) {
+            return false;
+        }
+        steps.emplace_back(std::move(premise1), std::move(premise2), std::move(resolvent));
+    }
+    return true;
+}
+
+// _i between separators becomes the i-th name, nothing else looks like it
+static std::string RenameVariables(const std::string &text, const ProblemVariables &variables)
+{
+    std::string out;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        size_t end = text.find_first_of(" ()", pos);
+        if (end == std::string::npos) end = text.size();
+
+        if (end == pos)
+        {
+            out += text[pos++];
+            continue;
+        }
+
+        std::string token = text.substr(pos, end - pos);
+        if (IsNumberedName(token))
+        {
+            size_t number = std::stoul(token.substr(1));
+            if (number < variables.names.size()) token = variables.names[number];
+        }
+        out += token;
+        pos = end;
+    }
+    return out;
+}
+
+std::vector<ProofStepStrings> RenameProofSteps(const std::vector<ProofStepStrings> &steps,
+                                               const ProblemVariables &variables)
+{
+    std::vector<ProofStepStrings> renamed;
+    for (const ProofStepStrings &step : steps)
+    {
+        renamed.emplace_back(RenameVariables(std::get<0>(step), variables),
+                             RenameVariables(std::get<1>(step), variables),
+                             RenameVariables(std::get<2>(step), variables));
+    }
+    return renamed;
+}
+
+uint64_t HashProblemKey(const std::string &key)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+ProofCache::ProofCache(size_t capacity, const std::string &directory)
+    : capacity(capacity), directory(directory)
+{
+    if (!directory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            throw std::runtime_error("Cannot create cache directory " + directory);
+        }
+    }
+}
+
+std::string ProofCache::EntryPath(const std::string &key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.rzc", (unsigned long long)HashProblemKey(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+void WriteCacheString(std::ostream &out, const std::string &str)
+{
+    out << str.size() << ' ' << str << '\n';
+}
+
+bool ReadCacheString(std::istream &in, std::string &str)
+{
+    size_t size;
+    if (!(in >> size) || in.get() != ' ') return false;
+
+    str.resize(size);
+    in.read(&str[0], size);
+    return in && in.get() == '\n';
+}
+
+bool ProofCache::LoadEntry(const std::string &key, CachedProof &proof) const
+{
+    std::ifstream in(EntryPath(key), std::ios::binary);
+    if (!in) return false;
+
+    std::string header, stored_key;
+    int result;
+    size_t steps;
+
+    if (!std::getline(in, header) || header != CACHE_ENTRY_HEADER) return false;
+    if (!ReadCacheString(in, stored_key) || stored_key != key) return false; // a hash collision
+    if (!(in >> result >> steps) || in.get() != '\n') return false;
+    if (result != (int)ProofResult::PROVED && result != (int)ProofResult::SATURATED) return false;
+
+    CachedProof loaded;
+    loaded.result = ProofResult(result);
+
+    for (size_t i = 0; i < steps; i++)
+    {
+        std::string premise1, premise2, resolvent;
+        if (!ReadCacheString(in, premise1) || !ReadCacheString(in, premise2) || !ReadCacheString(in, resolvent)) {
+            return false;
+        }
+        loaded.proof.emplace_back(premise1, premise2, resolvent);
+    }
+
+    proof = std::move(loaded);
+    return true;
+}
+
+void ProofCache::SaveEntry(const std::string &key, const CachedProof &proof) const
+{
+    static std::atomic<unsigned> temp_counter{0};
+
+    // written aside and renamed, so readers in other processes never see
+    // half of an entry
+    std::string path = EntryPath(key);
+    std::string temp = path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(temp_counter++);
+
+    {
+        std::ofstream out(temp, std::ios::binary);
+        if (!out) return;
+
+        out << CACHE_ENTRY_HEADER << '\n';
+        WriteCacheString(out, key);
+        out << (int)proof.result << ' ' << proof.proof.size() << '\n';
+
+        for (const ProofStepStrings &step : proof.proof)
+        {
+            WriteCacheString(out, std::get<0>(step));
+            WriteCacheString(out, std::get<1>(step));
+            WriteCacheString(out, std::get<2>(step));
+        }
+
+        if (!out) {
+            out.close();
+            std::remove(temp.c_str());
+            return;
+        }
+    }
+
+    // the disk tier is best effort, a full disk only costs a future miss
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+    }
+}
+
+void ProofCache::Remember(const std::string &key, const CachedProof &proof)
+{
+    auto it = by_key.find(key);
+    if (it != by_key.end())
+    {
+        entries.erase(it->second);
+        by_key.erase(it);
+    }
+
+    if (capacity == 0) return;
+
+    entries.push_front({key, proof});
+    by_key[key] = entries.begin();
+
+    if (entries.size() > capacity)
+    {
+        by_key.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+bool ProofCache::Lookup(const std::string &key, CachedProof &proof)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = by_key.find(key);
+        if (it != by_key.end())
+        {
+            entries.splice(entries.begin(), entries, it->second);
+            proof = it->second->proof;
+            hits++;
+            return true;
+        }
+    }
+
+    // the file is read without the lock, other lookups go on meanwhile
+    CachedProof loaded;
+    bool found = !directory.empty() && LoadEntry(key, loaded);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!found)
+    {
+        misses++;
+        return false;
+    }
+
+    Remember(key, loaded);
+    proof = std::move(loaded);
+    hits++;
+    return true;
+}
+
+void ProofCache::Store(const std::string &key, const CachedProof &proof)
+{
+    if (proof.result == ProofResult::UNKNOWN) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Remember(key, proof);
+    }
+
+    if (!directory.empty()) SaveEntry(key, proof);
+}
+
+void ProofCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    by_key.clear();
+}
+
+size_t ProofCache::Size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t ProofCache::Hits()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t ProofCache::Misses()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+} // namespace rzlogic
@@ -0,0 +1,366 @@
+#include "proof_log.hpp"
+#include "snapshot.hpp"
+#include <cctype>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace rzlogic {
+
+static const char          BINARY_MAGIC[] = {'R', 'Z', 'P', 'L'};
+static const unsigned char BINARY_VERSION = 1;
+
+static const unsigned char SYMBOL_RECORD = 1;
+static const unsigned char CLAUSE_RECORD = 2;
+
+std::string TstpSymbol(const std::string &name)
+{
+    bool plain = !name.empty() && islower(name[0]);
+    for (char c : name) {
+        plain = plain && (isalnum(c) || c == '_');
+    }
+    if (plain) return name;
+
+    std::string quoted = "'";
+    for (char c : name) {
+        if (c == '\'' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "'";
+}
+
+std::string TermAsTstp(Formula *f)
+{
+    if (f->type == FormulaType::VARIABLE) {
+        std::string name = f->str;
+        name[0] = toupper(name[0]);
+        return name;
+    }
+
+    std::string result = TstpSymbol(f->str);
+    if (f->children.empty()) return result;
+
+    result += "(";
+    for (size_t i = 0; i < f->children.size(); i++) {
+        if (i > 0) result += ",";
+        result += TermAsTstp(f->children[i]);
+    }
+    return result + ")";
+}
+
+std::string ClauseAsTstp(Formula *f)
+{
+    std::vector<Formula*> literals;
+    ClauseLiterals(f, literals);
+
+    if (literals.empty()) return "$false";
+
+    std::string result;
+    for (size_t i = 0; i < literals.size(); i++) {
+        if (i > 0) result += " | ";
+        if (literals[i]->type == FormulaType::NOT) {
+            result += "~" + TermAsTstp(literals[i]->children[0]);
+        }
+        else {
+            result += TermAsTstp(literals[i]);
+        }
+    }
+    return result;
+}
+
+ProofLog::ProofLog(const std::string &path, ProofLogFormat format, size_t buffer_size)
+    : path(path), format(format), buffer_size(buffer_size)
+{
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open proof log " + path);
+    }
+
+    buffer.reserve(buffer_size);
+    if (format == ProofLogFormat::BINARY) {
+        buffer.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        buffer += char(BINARY_VERSION);
+    }
+}
+
+ProofLog::~ProofLog()
+{
+    try {
+        Flush();
+    }
+    catch (const std::exception &) {
+        // nobody left to tell, see Flush
+    }
+    fclose(file);
+}
+
+// with the mutex held
+void ProofLog::WriteBuffer()
+{
+    size_t written = fwrite(buffer.data(), 1, buffer.size(), file);
+    bool   failed  = written != buffer.size();
+    buffer.clear();
+
+    if (failed) {
+        throw std::runtime_error("Cannot write proof log " + path);
+    }
+}
+
+void ProofLog::Flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    WriteBuffer();
+    if (fflush(file) != 0) {
+        throw std::runtime_error("Cannot write proof log " + path);
+    }
+}
+
+void ProofLog::Append(int id, int parent1, int parent2, InferenceRule rule, Formula *clause)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (format == ProofLogFormat::TSTP) WriteTstp(id, parent1, parent2, rule, clause);
+    else                                WriteBinary(id, parent1, parent2, rule, clause);
+
+    if (buffer.size() >= buffer_size) {
+        WriteBuffer();
+    }
+}
+
+void ProofLog::WriteTstp(int id, int parent1, int parent2, InferenceRule rule, Formula *clause)
+{
+    buffer += "cnf(c" + std::to_string(id);
+
+    if (rule == InferenceRule::INPUT) {
+        buffer += ", axiom, (" + ClauseAsTstp(clause) + ")).\n";
+        return;
+    }
+
+    buffer += ", plain, (" + ClauseAsTstp(clause) + "), inference(resolution, [status(thm)], [c"
+            + std::to_string(parent1) + ", c" + std::to_string(parent2) + "])).\n";
+}
+
+void ProofLog::WriteVarint(unsigned long long value)
+{
+    while (value >= 0x80) {
+        buffer += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer += char(value);
+}
+
+void ProofLog::WriteSymbol(const std::string &name)
+{
+    if (symbols.count(name)) return;
+
+    int symbol_id = symbols.size();
+    symbols[name] = symbol_id;
+
+    buffer += char(SYMBOL_RECORD);
+    WriteVarint(name.size());
+    buffer += name;
+}
+
+void ProofLog::DefineSymbols(Formula *f)
+{
+    if (f->type != FormulaType::NOT) WriteSymbol(f->str);
+
+    for (Formula *child : f->children) {
+        DefineSymbols(child);
+    }
+}
+
+void ProofLog::WriteTerm(Formula *f)
+{
+    buffer += char(f->type);
+    WriteVarint(symbols.at(f->str));
+    WriteVarint(f->children.size());
+
+    for (Formula *child : f->children) {
+        WriteTerm(child);
+    }
+}
+
+void ProofLog::WriteBinary(int id, int parent1, int parent2, InferenceRule rule, Formula *clause)
+{
+    std::vector<Formula*> literals;
+    ClauseLiterals(clause, literals);
+
+    // symbols have to be defined before the record that uses them
+    for (Formula *literal : literals) {
+        DefineSymbols(literal);
+    }
+
+    buffer += char(CLAUSE_RECORD);
+    WriteVarint(id);
+    WriteVarint(parent1 + 1);
+    WriteVarint(parent2 + 1);
+    buffer += char(rule);
+    WriteVarint(literals.size());
+
+    for (Formula *literal : literals) {
+        bool negated = (literal->type == FormulaType::NOT);
+        buffer += char(negated);
+        WriteTerm(negated ? literal->children[0] : literal);
+    }
+}
+
+// Reads a mapped log, every count and id is checked against what is
+// there, so a corrupted file throws instead of allocating or reading past
+// the end.
+class BinaryLogReader
+{
+private:
+    MappedFile               file;
+    std::string              path;
+    const char              *pos;
+    const char              *end;
+    std::vector<std::string> symbols;
+
+public:
+    explicit BinaryLogReader(const std::string &path)
+        : file(path), path(path), pos(file.Data()), end(file.Data() + file.Size()) {}
+
+    bool AtEnd() const { return pos == end; }
+
+    [[noreturn]] void Fail(const std::string &what) const
+    {
+        throw std::runtime_error(what + " at offset " + std::to_string(pos - file.Data()) + ": " + path);
+    }
+
+    unsigned char Byte()
+    {
+        if (pos == end) Fail("Truncated proof log");
+        return *pos++;
+    }
+
+    unsigned long long Varint()
+    {
+        unsigned long long value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            unsigned char c = Byte();
+            value |= (unsigned long long)(c & 0x7F) << shift;
+            if (!(c & 0x80)) return value;
+        }
+        Fail("Corrupted proof log");
+    }
+
+    // a count of items taking at least one byte each
+    size_t Count()
+    {
+        unsigned long long count = Varint();
+        if (count > (unsigned long long)(end - pos)) Fail("Corrupted proof log");
+        return count;
+    }
+
+    // ids and parents, written from ints
+    int Int()
+    {
+        unsigned long long value = Varint();
+        if (value > (unsigned long long)std::numeric_limits<int>::max()) Fail("Corrupted proof log");
+        return value;
+    }
+
+    void Symbol()
+    {
+        size_t length = Count();
+        symbols.emplace_back(pos, length);
+        pos += length;
+    }
+
+    FormulaPtr Term()
+    {
+        unsigned char type = Byte();
+        if (type > (unsigned char)FormulaType::EMPTY) Fail("Corrupted proof log");
+
+        FormulaPtr f(new Formula(FormulaType(type)));
+
+        unsigned long long symbol = Varint();
+        if (symbol >= symbols.size()) Fail("Undefined symbol in proof log");
+        f->str = symbols[symbol];
+
+        size_t arity = Count();
+        for (size_t i = 0; i < arity; i++) {
+            FormulaPtr child = Term();
+            f->children.push_back(child.release());
+        }
+        return f;
+    }
+
+    FormulaPtr Clause()
+    {
+        std::vector<FormulaPtr> literals(Count());
+
+        for (FormulaPtr &literal : literals) {
+            bool negated = Byte();
+            literal = Term();
+
+            if (negated) {
+                FormulaPtr not_literal(new Formula(FormulaType::NOT));
+                not_literal->children.push_back(literal.release());
+                literal = std::move(not_literal);
+            }
+        }
+
+        if (literals.empty()) return FormulaPtr(new Formula(FormulaType::EMPTY));
+
+        // (or l1 (or l2 l3)), the way resolvents are built
+        FormulaPtr clause = std::move(literals.back());
+        for (int i = (int)literals.size() - 2; i >= 0; i--) {
+            FormulaPtr or_clause(new Formula(FormulaType::OR));
+            or_clause->children.push_back(literals[i].release());
+            or_clause->children.push_back(clause.release());
+            clause = std::move(or_clause);
+        }
+        return clause;
+    }
+};
+
+void ReadProofLog(const std::string &path, const std::function<void(const ProofLogRecord&)> &func)
+{
+    std::unique_ptr<BinaryLogReader> opened;
+    try {
+        opened = std::make_unique<BinaryLogReader>(path);
+    }
+    catch (const std::runtime_error &) {
+        throw std::runtime_error("Cannot open proof log " + path);
+    }
+    BinaryLogReader &reader = *opened;
+
+    for (char c : BINARY_MAGIC) {
+        if (reader.AtEnd() || reader.Byte() != (unsigned char)c) {
+            throw std::runtime_error("Not a binary proof log: " + path);
+        }
+    }
+    if (reader.Byte() != BINARY_VERSION) {
+        throw std::runtime_error("Unsupported proof log version: " + path);
+    }
+
+    while (!reader.AtEnd())
+    {
+        unsigned char tag = reader.Byte();
+
+        if (tag == SYMBOL_RECORD) {
+            reader.Symbol();
+            continue;
+        }
+        if (tag != CLAUSE_RECORD) reader.Fail("Corrupted proof log");
+
+        ProofLogRecord record;
+        record.id      = reader.Int();
+        record.parent1 = reader.Int() - 1;
+        record.parent2 = reader.Int() - 1;
+
+        unsigned char rule = reader.Byte();
+        if (rule > (unsigned char)InferenceRule::RESOLUTION) reader.Fail("Corrupted proof log");
+        record.rule = InferenceRule(rule);
+
+        FormulaPtr clause = reader.Clause();
+        record.clause = clause.get();
+        func(record);
+    }
+}
+
+} // namespace rzlogic
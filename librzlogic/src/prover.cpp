@@ -0,0 +1,579 @@
+#include "prover.hpp"
+#include "parser.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace rzlogic {
+
+// Runs func(0) ... func(count - 1) on pool, or inline without one
+static void ForEachFormula(ThreadPool *pool, size_t count, const std::function<void(size_t)> &func)
+{
+    if (pool) {
+        pool->ParallelFor(count, func);
+    }
+    else {
+        for (size_t i = 0; i < count; i++) func(i);
+    }
+}
+
+// Adds the time of a stage and the terms it built to statistics, stages on
+// several threads add up under the mutex. Without statistics nothing is
+// measured. Every stage is also a slice of the trace, see trace.hpp.
+class StageMeter
+{
+private:
+    ProofStatistics *statistics;
+    std::mutex       mutex;
+
+public:
+    explicit StageMeter(ProofStatistics *statistics) : statistics(statistics) {}
+
+    template <typename Stage>
+    void Run(const char *name, double ProofStatistics::*seconds, const Stage &stage)
+    {
+        RZLOGIC_TRACE_SCOPE(name);
+
+        if (!statistics)
+        {
+            stage();
+            return;
+        }
+
+        auto   start  = std::chrono::steady_clock::now();
+        size_t before = FormulaAllocations();
+        stage();
+
+        double elapsed     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t allocations = FormulaAllocations() - before;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        statistics->*seconds += elapsed;
+        statistics->term_allocations += allocations;
+    }
+};
+
+static void MakePrenex(Formula *f, StageMeter &meter)
+{
+    meter.Run("normalize", &ProofStatistics::normalize_seconds, [f] { NormalizeFormula(f); });
+    meter.Run("prenex", &ProofStatistics::prenex_seconds, [f] { MakePrenexNormalForm(f); });
+}
+
+static bool ContainsExists(Formula *f)
+{
+    if (f->type == FormulaType::EXISTS) return true;
+    for (Formula *child : f->children) {
+        if (ContainsExists(child)) return true;
+    }
+    return false;
+}
+
+// Clausifies formulas in prenex form. Skolem symbols are made against the
+// table symbols() returns. Filling a table is the dearest part of
+// clausifying a fact base, so it is only asked for when some formula has
+// an existential to replace.
+//
+// Skolem symbols are handed out in input order on the calling thread, the
+// rest runs on pool: a block of formulas goes to CNF as soon as it is
+// Skolemized. The clauses are merged in input order, so the result does
+// not depend on the threads.
+static void ClausifyPrenexFormulas(std::vector<Formula*> &formulas, std::vector<Formula*> &clauses,
+                                   const std::function<SymbolTable&()> &symbols, ThreadPool *pool, StageMeter &meter)
+{
+    std::vector<char> has_exists(formulas.size());
+    ForEachFormula(pool, formulas.size(), [&](size_t i) { has_exists[i] = ContainsExists(formulas[i]); });
+
+    SymbolTable *table = nullptr;
+    if (std::find(has_exists.begin(), has_exists.end(), true) != has_exists.end()) {
+        meter.Run("symbols", &ProofStatistics::skolem_seconds, [&] { table = &symbols(); });
+    }
+
+    std::vector<std::vector<Formula*>> parts(formulas.size());
+    auto clausify = [&](size_t begin, size_t end)
+    {
+        meter.Run("cnf", &ProofStatistics::cnf_seconds, [&]
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                DropUniversalQuantifiers(formulas[i]);
+                MakeConjunctiveNormalForm(formulas[i]);
+                SplitConjunctions(formulas[i], parts[i]);
+            }
+        });
+    };
+
+    struct Pending
+    {
+        std::mutex              mutex;
+        std::condition_variable done;
+        size_t                  blocks = 0;
+        std::exception_ptr      error;
+    };
+    auto pending = std::make_shared<Pending>();
+
+    size_t block = pool ? std::max<size_t>(64, formulas.size() / (8 * std::max<size_t>(1, pool->Size()))) : formulas.size();
+    auto wait = [&pending]
+    {
+        std::unique_lock<std::mutex> lock(pending->mutex);
+        pending->done.wait(lock, [&pending] { return pending->blocks == 0; });
+    };
+
+    // the blocks use the locals, they are waited for even on an error
+    try
+    {
+        for (size_t begin = 0; begin < formulas.size(); begin += block)
+        {
+            size_t end = std::min(begin + block, formulas.size());
+
+            for (size_t i = begin; table && i < end; i++)
+            {
+                if (!has_exists[i]) continue;
+
+                // MakeSkolemNormalForm without adding the names again
+                meter.Run("skolem", &ProofStatistics::skolem_seconds, [&]
+                {
+                    std::vector<std::string> universal_vars;
+                    int skolem_counter = 0;
+                    Skolemize(formulas[i], universal_vars, skolem_counter, table);
+                });
+            }
+
+            if (!pool)
+            {
+                clausify(begin, end);
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                pending->blocks++;
+            }
+            pool->Submit([pending, &clausify, begin, end]
+            {
+                std::exception_ptr error;
+                try {
+                    clausify(begin, end);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                if (error && !pending->error) pending->error = error;
+                if (--pending->blocks == 0) pending->done.notify_all();
+            });
+        }
+    }
+    catch (...)
+    {
+        wait();
+        throw;
+    }
+
+    wait();
+    if (pending->error) std::rethrow_exception(pending->error);
+
+    for (std::vector<Formula*> &part : parts) {
+        clauses.insert(clauses.end(), part.begin(), part.end());
+    }
+    formulas.clear();
+}
+
+// a table with the names of all formulas, filled when asked for
+static std::function<SymbolTable&()> FormulaSymbols(SymbolTable &symbols, const std::vector<Formula*> &formulas)
+{
+    return [&symbols, &formulas]() -> SymbolTable&
+    {
+        for (Formula *f : formulas) symbols.Add(f);
+        return symbols;
+    };
+}
+
+void ClausifyPremises(const std::vector<std::string> &premises, std::vector<Formula*> &clauses, ThreadPool *pool,
+                      ProofStatistics *statistics)
+{
+    StageMeter meter(statistics);
+
+    // every premise is parsed and put in prenex form on its own, an error
+    // is the one of the first premise that fails
+    std::vector<Formula*> formulas(premises.size(), nullptr);
+    std::vector<std::exception_ptr> errors(premises.size());
+
+    ForEachFormula(pool, premises.size(), [&](size_t i)
+    {
+        try
+        {
+            meter.Run("parse", &ProofStatistics::parse_seconds, [&] { formulas[i] = Parser(premises[i]).Parse(); });
+            MakePrenex(formulas[i], meter);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    for (const std::exception_ptr &error : errors)
+    {
+        if (!error) continue;
+
+        for (Formula *f : formulas) {
+            if (f) DeleteFormula(f);
+        }
+        std::rethrow_exception(error);
+    }
+
+    SymbolTable symbols;
+    ClausifyPrenexFormulas(formulas, clauses, FormulaSymbols(symbols, formulas), pool, meter);
+}
+
+void ClausifyFormulas(std::vector<Formula*> &formulas, std::vector<Formula*> &clauses, ThreadPool *pool,
+                      ProofStatistics *statistics)
+{
+    StageMeter meter(statistics);
+    ForEachFormula(pool, formulas.size(), [&](size_t i) { MakePrenex(formulas[i], meter); });
+
+    SymbolTable symbols;
+    ClausifyPrenexFormulas(formulas, clauses, FormulaSymbols(symbols, formulas), pool, meter);
+}
+
+void ClausifyPremiseFile(const std::string &path, std::vector<Formula*> &clauses, ThreadPool *pool,
+                         ProofStatistics *statistics)
+{
+    StageMeter meter(statistics);
+    std::vector<Formula*> formulas;
+    std::unique_ptr<StreamParser> parser;
+
+    try
+    {
+        meter.Run("parse", &ProofStatistics::parse_seconds, [&]
+        {
+            parser = std::make_unique<StreamParser>(path);
+            parser->Parse([&formulas](Formula *f) { formulas.push_back(f); });
+        });
+    }
+    catch (...)
+    {
+        for (Formula *f : formulas) DeleteFormula(f);
+        throw;
+    }
+
+    ForEachFormula(pool, formulas.size(), [&](size_t i) { MakePrenex(formulas[i], meter); });
+    ClausifyPrenexFormulas(formulas, clauses, [&parser]() -> SymbolTable& { return parser->Symbols(); }, pool, meter);
+}
+
+// Buffers kept by every batch worker between problems, so a problem does
+// not pay for growing them again.
+struct BatchScratch
+{
+    std::vector<Formula*>           clauses;
+    std::vector<ResolutionStepInfo> history;
+};
+
+static thread_local BatchScratch batch_scratch;
+
+void ProveBatchProblem(const std::vector<std::string> &premises, BatchResult &result, const ResolutionOptions &options)
+{
+    RZLOGIC_TRACE_SCOPE("problem");
+    BatchScratch &scratch = batch_scratch;
+    scratch.clauses.clear();
+    scratch.history.clear();
+
+    ProofStatistics *statistics = options.statistics ? &result.statistics : nullptr;
+
+    try {
+        ClausifyPremises(premises, scratch.clauses, nullptr, statistics);
+    }
+    catch (const std::exception &e) {
+        result.error = e.what();
+        return;
+    }
+
+    ResolutionOptions problem_options = options;
+    problem_options.statistics = statistics;
+    result.result = MakeResolution(scratch.clauses, scratch.history, problem_options);
+
+    for (const ResolutionStepInfo &step : scratch.history)
+    {
+        result.proof.emplace_back(FormulaAsString(step.premise1),
+                                  FormulaAsString(step.premise2),
+                                  FormulaAsString(step.resolvent));
+    }
+
+    DeleteHistory(scratch.history);
+    for (Formula *f : scratch.clauses) DeleteFormula(f);
+    scratch.clauses.clear();
+}
+
+void MakeResolutionBatch(const std::vector<std::vector<std::string>> &problems, std::vector<BatchResult> &results,
+                         int threads, const ResolutionOptions &options)
+{
+    results.assign(problems.size(), BatchResult());
+    if (problems.empty()) return;
+
+    ResolutionOptions problem_options = options;
+    problem_options.threads  = 1;
+    problem_options.poll     = nullptr;
+    problem_options.progress = nullptr;
+
+    ThreadPool pool(std::max(threads, 1));
+
+    std::mutex              mutex;
+    std::condition_variable finished;
+    size_t remaining = problems.size();
+
+    for (size_t i = 0; i < problems.size(); i++)
+    {
+        pool.Submit([&, i]
+        {
+            ProveBatchProblem(problems[i], results[i], problem_options);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) finished.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (remaining > 0)
+    {
+        if (options.poll)
+        {
+            lock.unlock();
+            options.poll();
+            lock.lock();
+        }
+        finished.wait_for(lock, std::chrono::milliseconds(10), [&remaining] { return remaining == 0; });
+    }
+
+    if (options.statistics) {
+        for (const BatchResult &result : results) options.statistics->Add(result.statistics);
+    }
+}
+
+ProofDag::ProofDag(std::vector<ResolutionStepInfo> &history)
+{
+    for (const ResolutionStepInfo &step : history)
+    {
+        if (step.premise1_id < 0 || step.premise2_id < 0 || step.resolvent_id < 0) {
+            throw std::runtime_error("Proof steps have no clause ids");
+        }
+    }
+
+    // a clause shows up once per step using it, the first copy is kept
+    std::map<int, Formula*>      by_id;
+    std::map<int, ClauseParents> parents_by_id;
+
+    auto take = [&by_id](int id, Formula *&f)
+    {
+        if (by_id.emplace(id, f).second) f = nullptr;
+    };
+
+    for (ResolutionStepInfo &step : history)
+    {
+        take(step.premise1_id, step.premise1);
+        take(step.premise2_id, step.premise2);
+        take(step.resolvent_id, step.resolvent);
+        parents_by_id[step.resolvent_id] = {step.premise1_id, step.premise2_id};
+    }
+
+    for (ResolutionStepInfo &step : history)
+    {
+        for (Formula *f : {step.premise1, step.premise2, step.resolvent}) {
+            if (f) DeleteFormula(f);
+        }
+    }
+    history.clear();
+
+    // parents have smaller ids, so they are numbered before their children
+    std::map<int, int> index;
+    for (auto &entry : by_id)
+    {
+        index[entry.first] = clauses.size();
+        clauses.push_back(entry.second);
+        search_ids.push_back(entry.first);
+
+        auto it = parents_by_id.find(entry.first);
+        if (it == parents_by_id.end())
+        {
+            parents.push_back(-1);
+            parents.push_back(-1);
+        }
+        else
+        {
+            parents.push_back(index.at(it->second.parent1));
+            parents.push_back(index.at(it->second.parent2));
+        }
+    }
+}
+
+ProofDag::ProofDag(std::vector<Formula*> clauses, std::vector<int32_t> parents, std::vector<int32_t> search_ids)
+    : clauses(std::move(clauses)), parents(std::move(parents)), search_ids(std::move(search_ids))
+{
+    if (this->parents.size() != 2 * this->clauses.size() || this->search_ids.size() != this->clauses.size())
+    {
+        for (Formula *f : this->clauses) DeleteFormula(f);
+        throw std::runtime_error("Proof parts differ in size");
+    }
+}
+
+ProofDag::~ProofDag()
+{
+    for (Formula *f : clauses) DeleteFormula(f);
+}
+
+ProverSession::~ProverSession()
+{
+    DeleteHistory(proof);
+
+    for (Formula *f : clauses) DeleteFormula(f);
+}
+
+void ProverSession::AddFormula(const std::string &formula, bool goal)
+{
+    std::vector<Formula*> new_clauses;
+    Formula *f = Parser(formula).Parse();
+
+    if (goal)
+    {
+        Formula *negated = new Formula(FormulaType::NOT);
+        negated->children.push_back(f);
+        f = negated;
+    }
+
+    NormalizeFormula(f);
+    MakePrenexNormalForm(f);
+    MakeSkolemNormalForm(f, symbols);
+    MakeConjunctiveNormalForm(f);
+    SplitConjunctions(f, new_clauses);
+
+    clauses.insert(clauses.end(), new_clauses.begin(), new_clauses.end());
+    goal_clauses.resize(clauses.size(), goal);
+}
+
+void ProverSession::AddPremise(const std::string &formula)
+{
+    AddFormula(formula, false);
+}
+
+void ProverSession::AddGoal(const std::string &formula)
+{
+    AddFormula(formula, true);
+}
+
+ProofResult ProverSession::Prove(const ResolutionLimits &limits)
+{
+    ResolutionOptions options;
+    options.limits         = limits;
+    options.set_of_support = true;
+
+    return Prove(options);
+}
+
+ProofResult ProverSession::Prove(const ResolutionOptions &options)
+{
+    DeleteHistory(proof);
+
+    for (; fed < clauses.size(); ++fed)
+    {
+        state.AddInput(clauses[fed], goal_clauses[fed]);
+    }
+
+    return state.Run(options, proof);
+}
+
+SessionCheckpoint ProverSession::Checkpoint() const
+{
+    SessionCheckpoint checkpoint;
+    checkpoint.clauses = clauses.size();
+    checkpoint.fed     = fed;
+    checkpoint.state   = state.Checkpoint();
+    return checkpoint;
+}
+
+void ProverSession::Restore(const SessionCheckpoint &checkpoint)
+{
+    DeleteHistory(proof);
+    state.Restore(checkpoint.state);
+
+    // the state only borrowed them
+    for (size_t i = checkpoint.clauses; i < clauses.size(); ++i)
+    {
+        DeleteFormula(clauses[i]);
+    }
+
+    clauses.resize(checkpoint.clauses);
+    goal_clauses.resize(checkpoint.clauses);
+    fed = checkpoint.fed;
+}
+
+void ProverSession::MakeSnapshot(TheorySnapshot &snapshot, bool saturation) const
+{
+    snapshot.symbols.assign(symbols.Names().begin(), symbols.Names().end());
+    snapshot.clauses = clauses;
+    snapshot.goals   = goal_clauses;
+
+    if (saturation)
+    {
+        snapshot.has_saturation   = true;
+        snapshot.saturated_inputs = fed;
+        state.Export(snapshot.saturation);
+    }
+}
+
+void ProverSession::TakeSnapshot(TheorySnapshot &snapshot)
+{
+    for (const std::string &symbol : snapshot.symbols) symbols.Insert(symbol);
+
+    clauses      = snapshot.clauses;
+    goal_clauses = snapshot.goals;
+
+    if (snapshot.has_saturation)
+    {
+        state.Import(snapshot.saturation);
+        fed = snapshot.saturated_inputs;
+    }
+}
+
+void ProverSession::SaveSnapshot(const std::string &path, bool saturation) const
+{
+    TheorySnapshot snapshot;
+    MakeSnapshot(snapshot, saturation);
+    WriteSnapshot(path, snapshot);
+}
+
+void ProverSession::LoadSnapshot(const std::string &path)
+{
+    if (!clauses.empty() || state.Size() > 0)
+    {
+        throw std::runtime_error("Snapshots can only be loaded into an empty session");
+    }
+
+    TheorySnapshot snapshot;
+    ReadSnapshot(path, snapshot);
+    TakeSnapshot(snapshot);
+}
+
+std::string ProverSession::Serialize(bool saturation) const
+{
+    TheorySnapshot snapshot;
+    MakeSnapshot(snapshot, saturation);
+    return SerializeSnapshot(snapshot);
+}
+
+void ProverSession::Deserialize(const char *data, size_t size)
+{
+    if (!clauses.empty() || state.Size() > 0)
+    {
+        throw std::runtime_error("Snapshots can only be loaded into an empty session");
+    }
+
+    TheorySnapshot snapshot;
+    DeserializeSnapshot(data, size, snapshot);
+    TakeSnapshot(snapshot);
+}
+
+} // namespace rzlogic
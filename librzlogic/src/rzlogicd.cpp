@@ -0,0 +1,70 @@
+#include "server.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace rzlogic;
+
+static void Usage()
+{
+    std::cerr << "usage: rzlogicd SOCKET [--threads N] [--cache-capacity N] [--cache-dir DIR] [--max-seconds S]\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        Usage();
+        return 2;
+    }
+
+    ServerOptions options;
+    options.socket_path = argv[1];
+
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            Usage();
+            return 2;
+        }
+
+        const char *value = argv[++i];
+        if (arg == "--threads") options.threads = std::strtoul(value, nullptr, 10);
+        else if (arg == "--cache-capacity") options.cache_capacity = std::strtoul(value, nullptr, 10);
+        else if (arg == "--cache-dir") options.cache_directory = value;
+        else if (arg == "--max-seconds") options.max_seconds = std::strtod(value, nullptr);
+        else
+        {
+            Usage();
+            return 2;
+        }
+    }
+
+    // blocked before any thread starts, so only sigwait below sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try
+    {
+        ProofServer server(options);
+        server.Start();
+        std::cerr << "rzlogicd: listening on " << options.socket_path << "\n";
+
+        int signal;
+        sigwait(&signals, &signal);
+        server.Stop();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "rzlogicd: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
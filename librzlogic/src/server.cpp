@@ -0,0 +1,463 @@
+#include "server.hpp"
+#include "prover.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace rzlogic {
+
+static const uint32_t MAX_FRAME_SIZE = 64 << 20;
+
+static bool ReadBytes(int fd, char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool WriteBytes(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        // a client gone away must not kill the server with SIGPIPE
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool ReadFrame(int fd, std::string &payload)
+{
+    unsigned char header[4];
+    if (!ReadBytes(fd, (char*)header, sizeof(header))) return false;
+
+    uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    if (size > MAX_FRAME_SIZE) return false;
+
+    payload.resize(size);
+    return ReadBytes(fd, &payload[0], size);
+}
+
+bool WriteFrame(int fd, const std::string &payload)
+{
+    uint32_t size = payload.size();
+    unsigned char header[4] = {
+        (unsigned char)size, (unsigned char)(size >> 8), (unsigned char)(size >> 16), (unsigned char)(size >> 24)
+    };
+    return WriteBytes(fd, (const char*)header, sizeof(header)) && WriteBytes(fd, payload.data(), payload.size());
+}
+
+static sockaddr_un SocketAddress(const std::string &path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Bad socket path " + path);
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return address;
+}
+
+// The lines of a prove or load request
+struct ServerRequest
+{
+    std::string              theory;
+    std::string              snapshot;
+    std::vector<std::string> premises;
+    std::vector<std::string> goals;
+    ResolutionLimits         limits;
+    bool                     saturate = false;
+};
+
+static double ParseNumber(const std::string &name, const std::string &value)
+{
+    char *end;
+    double number = strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || number < 0) {
+        throw std::runtime_error("Bad value of " + name + ": " + value);
+    }
+    return number;
+}
+
+static ServerRequest ParseRequest(const std::vector<std::string> &lines)
+{
+    ServerRequest request;
+
+    for (size_t i = 1; i < lines.size(); i++)
+    {
+        if (lines[i].empty()) continue;
+
+        size_t space = lines[i].find(' ');
+        std::string name  = lines[i].substr(0, space);
+        std::string value = (space == std::string::npos) ? "" : lines[i].substr(space + 1);
+
+        if (name == "premise") request.premises.push_back(value);
+        else if (name == "goal") request.goals.push_back(value);
+        else if (name == "theory") request.theory = value;
+        else if (name == "snapshot") request.snapshot = value;
+        else if (name == "saturate") request.saturate = true;
+        else if (name == "timeout") request.limits.max_seconds = ParseNumber(name, value);
+        else if (name == "max_clauses") request.limits.max_generated = ParseNumber(name, value);
+        else if (name == "max_memory") request.limits.max_memory = ParseNumber(name, value);
+        else if (name == "max_term_depth") request.limits.max_term_depth = ParseNumber(name, value);
+        else throw std::runtime_error("Unknown field " + name);
+    }
+
+    return request;
+}
+
+static const char *ResultName(ProofResult result)
+{
+    switch (result) {
+    case ProofResult::PROVED:    return "proved";
+    case ProofResult::SATURATED: return "saturated";
+    case ProofResult::UNKNOWN:   break;
+    }
+    return "unknown";
+}
+
+static std::string ProofResponse(const CachedProof &proof)
+{
+    std::string response = std::string("ok ") + ResultName(proof.result) + "\n";
+    for (const ProofStepStrings &step : proof.proof)
+    {
+        response += "step " + std::get<0>(step) + "\t" + std::get<1>(step) + "\t" + std::get<2>(step) + "\n";
+    }
+    return response;
+}
+
+ProofServer::ProofServer(const ServerOptions &options)
+    : options(options), cache(options.cache_capacity, options.cache_directory)
+{
+    sockaddr_un address = SocketAddress(options.socket_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Cannot create socket");
+    }
+
+    unlink(options.socket_path.c_str());
+    if (bind(listen_fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd, 64) != 0)
+    {
+        close(listen_fd);
+        throw std::runtime_error("Cannot listen on " + options.socket_path + ": " + strerror(errno));
+    }
+
+    size_t threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    pool = std::make_unique<ThreadPool>(threads);
+}
+
+ProofServer::~ProofServer()
+{
+    Stop();
+}
+
+void ProofServer::Start()
+{
+    acceptor = std::thread(&ProofServer::AcceptLoop, this);
+}
+
+void ProofServer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped) return;
+        stopped = true;
+    }
+
+    shutdown.Cancel();
+
+    // wakes the acceptor up
+    ::shutdown(listen_fd, SHUT_RDWR);
+    if (acceptor.joinable()) acceptor.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : clients) ::shutdown(fd, SHUT_RDWR);
+    }
+
+    // the acceptor is gone, nobody adds connections any more
+    for (auto &connection : connections) connection.second.join();
+    connections.clear();
+
+    pool.reset();
+    close(listen_fd);
+    unlink(options.socket_path.c_str());
+}
+
+void ProofServer::AcceptLoop()
+{
+    size_t next_connection = 0;
+
+    while (true)
+    {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0 && errno == EINTR) continue;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // threads of closed connections
+        for (size_t id : finished)
+        {
+            connections[id].join();
+            connections.erase(id);
+        }
+        finished.clear();
+
+        if (fd < 0) break;
+        if (stopped)
+        {
+            close(fd);
+            break;
+        }
+
+        size_t id = next_connection++;
+        clients.insert(fd);
+        connections.emplace(id, std::thread(&ProofServer::Serve, this, fd, id));
+    }
+}
+
+void ProofServer::Serve(int fd, size_t id)
+{
+    std::string request;
+
+    while (ReadFrame(fd, request))
+    {
+        // Handle answers errors itself, get only waits
+        std::string response;
+        std::packaged_task<void()> task([this, &request, &response] { response = Handle(request); });
+        std::future<void> done = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(std::move(task));
+        }
+
+        // one pool task per queued request, whichever runs first takes the oldest
+        pool->Submit([this] { RunOldest(); });
+        done.get();
+
+        if (!WriteFrame(fd, response)) break;
+    }
+
+    // closed under the lock, so Stop never shuts down a reused descriptor
+    std::lock_guard<std::mutex> lock(mutex);
+    clients.erase(fd);
+    close(fd);
+    finished.push_back(id);
+}
+
+void ProofServer::RunOldest()
+{
+    std::packaged_task<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        task = std::move(queue.front());
+        queue.pop_front();
+    }
+    task();
+}
+
+std::string ProofServer::Handle(const std::string &request)
+{
+    requests++;
+
+    std::vector<std::string> lines;
+    std::istringstream stream(request);
+    for (std::string line; std::getline(stream, line); )
+    {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(line);
+    }
+
+    try
+    {
+        if (lines.empty()) throw std::runtime_error("Empty request");
+
+        const std::string &command = lines[0];
+        if (command == "prove") return Prove(lines);
+        if (command == "stats") return Stats();
+
+        if (command.compare(0, 5, "load ") == 0) return Load(lines);
+        if (command.compare(0, 5, "drop ") == 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (theories.erase(command.substr(5)) == 0) throw std::runtime_error("Unknown theory " + command.substr(5));
+            return "ok\n";
+        }
+
+        throw std::runtime_error("Unknown command " + command);
+    }
+    catch (const std::exception &e)
+    {
+        std::string message = e.what();
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        return "error " + message + "\n";
+    }
+}
+
+void ProofServer::CapSeconds(double &seconds) const
+{
+    if (options.max_seconds > 0 && (seconds == 0 || seconds > options.max_seconds)) seconds = options.max_seconds;
+}
+
+std::string ProofServer::Prove(const std::vector<std::string> &lines)
+{
+    ServerRequest request = ParseRequest(lines);
+    ProverSession session;
+
+    if (!request.theory.empty())
+    {
+        std::shared_ptr<const std::string> theory;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = theories.find(request.theory);
+            if (it == theories.end()) throw std::runtime_error("Unknown theory " + request.theory);
+            theory = it->second;
+        }
+        session.Deserialize(theory->data(), theory->size());
+    }
+
+    for (const std::string &premise : request.premises) session.AddPremise(premise);
+    for (const std::string &goal : request.goals) session.AddGoal(goal);
+
+    // goals are searched from, so they are a part of the problem
+    std::vector<Formula*> premises, goals;
+    for (size_t i = 0; i < session.Clauses().size(); i++)
+    {
+        (session.GoalClauses()[i] ? goals : premises).push_back(session.Clauses()[i]);
+    }
+    ProblemVariables variables;
+    NumberProblemVariables(premises, variables);
+    NumberProblemVariables(goals, variables);
+
+    std::string key;
+    if (variables.renamable) key = CanonicalProblemKey(premises) + "goals\n" + CanonicalProblemKey(goals) + variables.pattern;
+
+    CachedProof proof;
+    if (!key.empty() && cache.Lookup(key, proof))
+    {
+        proof.proof = RenameProofSteps(proof.proof, variables);
+        return ProofResponse(proof);
+    }
+
+    ResolutionOptions prove_options;
+    prove_options.limits         = request.limits;
+    prove_options.set_of_support = true;
+    prove_options.cancel         = shutdown.Child();
+    CapSeconds(prove_options.limits.max_seconds);
+
+    proof.result = session.Prove(prove_options);
+    for (const ResolutionStepInfo &step : session.Proof())
+    {
+        proof.proof.emplace_back(FormulaAsString(step.premise1),
+                                 FormulaAsString(step.premise2),
+                                 FormulaAsString(step.resolvent));
+    }
+
+    // cached with numbered variables, a renamed problem gets its own names
+    CachedProof cached;
+    cached.result = proof.result;
+    if (!key.empty() && CanonicalProofSteps(session.Proof(), variables, cached.proof)) cache.Store(key, cached);
+
+    return ProofResponse(proof);
+}
+
+std::string ProofServer::Load(const std::vector<std::string> &lines)
+{
+    std::string name = lines[0].substr(5);
+    ServerRequest request = ParseRequest(lines);
+
+    if (name.empty()) throw std::runtime_error("Theory without a name");
+    if (!request.theory.empty()) throw std::runtime_error("Theories cannot extend theories");
+
+    ProverSession session;
+    if (!request.snapshot.empty()) session.LoadSnapshot(request.snapshot);
+
+    for (const std::string &premise : request.premises) session.AddPremise(premise);
+    for (const std::string &goal : request.goals) session.AddGoal(goal);
+
+    if (request.saturate)
+    {
+        ResolutionOptions saturate_options;
+        saturate_options.limits         = request.limits;
+        saturate_options.set_of_support = true;
+        saturate_options.cancel         = shutdown.Child();
+        CapSeconds(saturate_options.limits.max_seconds);
+        session.Prove(saturate_options);
+    }
+
+    auto theory = std::make_shared<const std::string>(session.Serialize(request.saturate));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    theories[name] = theory;
+    return "ok\n";
+}
+
+std::string ProofServer::Stats()
+{
+    size_t theory_count;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        theory_count = theories.size();
+    }
+
+    return "ok\n"
+           "requests " + std::to_string(requests) + "\n"
+           "theories " + std::to_string(theory_count) + "\n"
+           "threads " + std::to_string(pool->Size()) + "\n"
+           "cache_size " + std::to_string(cache.Size()) + "\n"
+           "cache_hits " + std::to_string(cache.Hits()) + "\n"
+           "cache_misses " + std::to_string(cache.Misses()) + "\n";
+}
+
+ProofClient::ProofClient(const std::string &socket_path)
+{
+    sockaddr_un address = SocketAddress(socket_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create socket");
+    }
+
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot connect to " + socket_path + ": " + strerror(errno));
+    }
+}
+
+ProofClient::~ProofClient()
+{
+    close(fd);
+}
+
+std::string ProofClient::Request(const std::string &request)
+{
+    std::string response;
+    if (!WriteFrame(fd, request) || !ReadFrame(fd, response)) {
+        throw std::runtime_error("Connection to the prover closed");
+    }
+    return response;
+}
+
+} // namespace rzlogic
@@ -0,0 +1,442 @@
+#include "snapshot.hpp"
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rzlogic {
+
+static const char          SNAPSHOT_MAGIC[] = {'R', 'Z', 'S', 'N'};
+static const unsigned char SNAPSHOT_VERSION = 1;
+
+static const char          PROOF_MAGIC[] = {'R', 'Z', 'P', 'F'};
+static const unsigned char PROOF_VERSION = 1;
+
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+
+    size = st.st_size;
+    if (size > 0)
+    {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+
+    // the mapping keeps the file alive
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+class SnapshotWriter
+{
+private:
+    std::string                buffer;
+    std::map<std::string, int> strings;
+
+public:
+    void Byte(unsigned char value) { buffer += char(value); }
+
+    void Varint(unsigned long long value)
+    {
+        while (value >= 0x80) {
+            buffer += char((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        buffer += char(value);
+    }
+
+    void CollectStrings(Formula *f)
+    {
+        strings.emplace(f->str, 0);
+        for (Formula *child : f->children) {
+            CollectStrings(child);
+        }
+    }
+
+    void CollectString(const std::string &str) { strings.emplace(str, 0); }
+
+    // numbers the collected strings, every term after this may use them
+    void StringTable()
+    {
+        int string_id = 0;
+        Varint(strings.size());
+
+        for (auto &entry : strings) {
+            entry.second = string_id++;
+            Varint(entry.first.size());
+            buffer += entry.first;
+        }
+    }
+
+    void String(const std::string &str) { Varint(strings.at(str)); }
+
+    void Term(Formula *f)
+    {
+        Byte((unsigned char)f->type);
+        String(f->str);
+        Varint(f->children.size());
+
+        for (Formula *child : f->children) {
+            Term(child);
+        }
+    }
+
+    std::string Take() { return std::move(buffer); }
+};
+
+class SnapshotReader
+{
+private:
+    const char *pos;
+    const char *end;
+    std::vector<std::string> strings;
+
+public:
+    SnapshotReader(const char *data, size_t size) : pos(data), end(data + size) {}
+
+    unsigned char Byte()
+    {
+        if (pos == end) {
+            throw std::runtime_error("Truncated snapshot");
+        }
+        return *pos++;
+    }
+
+    unsigned long long Varint()
+    {
+        unsigned long long value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            unsigned char c = Byte();
+            value |= (unsigned long long)(c & 0x7F) << shift;
+            if (!(c & 0x80)) return value;
+        }
+        throw std::runtime_error("Corrupted snapshot");
+    }
+
+    // a count of items taking at least one byte each
+    size_t Count()
+    {
+        unsigned long long count = Varint();
+        if (count > (unsigned long long)(end - pos)) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+        return count;
+    }
+
+    void StringTable()
+    {
+        size_t count = Count();
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t length = Count();
+            strings.emplace_back(pos, length);
+            pos += length;
+        }
+    }
+
+    const std::string &String()
+    {
+        unsigned long long string_id = Varint();
+        if (string_id >= strings.size()) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+        return strings[string_id];
+    }
+
+    Formula *Term()
+    {
+        unsigned char type = Byte();
+        if (type > (unsigned char)FormulaType::EMPTY) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+
+        Formula *f = new Formula(FormulaType(type));
+        try
+        {
+            f->str = String();
+
+            size_t arity = Count();
+            for (size_t i = 0; i < arity; i++) {
+                f->children.push_back(Term());
+            }
+        }
+        catch (...)
+        {
+            DeleteFormula(f);
+            throw;
+        }
+        return f;
+    }
+};
+
+std::string SerializeSnapshot(const TheorySnapshot &snapshot)
+{
+    SnapshotWriter writer;
+    const SaturationImage &saturation = snapshot.saturation;
+
+    for (const std::string &symbol : snapshot.symbols) writer.CollectString(symbol);
+    for (Formula *f : snapshot.clauses) writer.CollectStrings(f);
+    if (snapshot.has_saturation) {
+        for (Formula *f : saturation.clauses) writer.CollectStrings(f);
+    }
+
+    for (char c : SNAPSHOT_MAGIC) writer.Byte(c);
+    writer.Byte(SNAPSHOT_VERSION);
+    writer.StringTable();
+
+    writer.Varint(snapshot.symbols.size());
+    for (const std::string &symbol : snapshot.symbols) writer.String(symbol);
+
+    writer.Varint(snapshot.clauses.size());
+    for (size_t i = 0; i < snapshot.clauses.size(); i++)
+    {
+        writer.Byte(snapshot.goals[i]);
+        writer.Term(snapshot.clauses[i]);
+    }
+
+    writer.Byte(snapshot.has_saturation);
+    if (snapshot.has_saturation)
+    {
+        writer.Varint(snapshot.saturated_inputs);
+        writer.Varint(saturation.clauses.size());
+
+        // inputs come in the order of snapshot.clauses, so only the derived
+        // clauses are written again
+        for (size_t id = 0; id < saturation.clauses.size(); id++)
+        {
+            writer.Varint(saturation.parents[id].parent1 + 1);
+            writer.Varint(saturation.parents[id].parent2 + 1);
+            writer.Byte(saturation.supported[id]);
+
+            if (saturation.parents[id].parent1 >= 0) writer.Term(saturation.clauses[id]);
+        }
+
+        writer.Varint(saturation.active.size());
+        for (int id : saturation.active) writer.Varint(id);
+
+        writer.Varint(saturation.picks);
+        writer.Byte(saturation.dropped);
+    }
+
+    return writer.Take();
+}
+
+void WriteSnapshot(const std::string &path, const TheorySnapshot &snapshot)
+{
+    std::string buffer = SerializeSnapshot(snapshot);
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open snapshot " + path);
+    }
+
+    bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = (fclose(file) == 0) && written;
+
+    if (!written) {
+        throw std::runtime_error("Cannot write snapshot " + path);
+    }
+}
+
+void ReadSnapshotContents(SnapshotReader &reader, TheorySnapshot &snapshot)
+{
+    for (char c : SNAPSHOT_MAGIC) {
+        if (reader.Byte() != (unsigned char)c) {
+            throw std::runtime_error("Not a snapshot");
+        }
+    }
+    if (reader.Byte() != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version");
+    }
+
+    reader.StringTable();
+
+    size_t symbols = reader.Count();
+    for (size_t i = 0; i < symbols; i++) {
+        snapshot.symbols.push_back(reader.String());
+    }
+
+    size_t inputs = reader.Count();
+    for (size_t i = 0; i < inputs; i++)
+    {
+        snapshot.goals.push_back(reader.Byte());
+        snapshot.clauses.push_back(reader.Term());
+    }
+
+    snapshot.has_saturation = reader.Byte();
+    if (!snapshot.has_saturation) return;
+
+    SaturationImage &saturation = snapshot.saturation;
+    snapshot.saturated_inputs = reader.Varint();
+    if (snapshot.saturated_inputs > inputs) {
+        throw std::runtime_error("Corrupted snapshot");
+    }
+
+    size_t clauses = reader.Count();
+    size_t next_input = 0;
+    for (size_t id = 0; id < clauses; id++)
+    {
+        ClauseParents parents;
+        parents.parent1 = int(reader.Varint()) - 1;
+        parents.parent2 = int(reader.Varint()) - 1;
+
+        // parents are older than their children
+        if (parents.parent1 >= (int)id || parents.parent2 >= (int)id || (parents.parent1 < 0) != (parents.parent2 < 0)) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+
+        saturation.parents.push_back(parents);
+        saturation.supported.push_back(reader.Byte());
+
+        if (parents.parent1 >= 0) {
+            saturation.clauses.push_back(reader.Term());
+        }
+        else if (next_input < snapshot.saturated_inputs) {
+            saturation.clauses.push_back(snapshot.clauses[next_input++]);
+        }
+        else {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+    }
+
+    if (next_input != snapshot.saturated_inputs) {
+        throw std::runtime_error("Corrupted snapshot");
+    }
+
+    size_t active = reader.Count();
+    for (size_t i = 0; i < active; i++)
+    {
+        unsigned long long id = reader.Varint();
+        if (id >= clauses) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+        saturation.active.push_back(id);
+    }
+
+    saturation.picks   = reader.Varint();
+    saturation.dropped = reader.Byte();
+}
+
+void DeserializeSnapshot(const char *data, size_t size, TheorySnapshot &snapshot)
+{
+    SnapshotReader reader(data, size);
+
+    try
+    {
+        ReadSnapshotContents(reader, snapshot);
+    }
+    catch (const std::runtime_error&)
+    {
+        for (size_t id = 0; id < snapshot.saturation.clauses.size(); id++)
+        {
+            if (snapshot.saturation.parents[id].parent1 >= 0) DeleteFormula(snapshot.saturation.clauses[id]);
+        }
+        for (Formula *f : snapshot.clauses) DeleteFormula(f);
+
+        snapshot = TheorySnapshot();
+        throw;
+    }
+}
+
+void ReadSnapshot(const std::string &path, TheorySnapshot &snapshot)
+{
+    MappedFile file(path);
+
+    try
+    {
+        DeserializeSnapshot(file.Data(), file.Size(), snapshot);
+    }
+    catch (const std::runtime_error &e)
+    {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+}
+
+std::string SerializeProof(const ProofDag &proof)
+{
+    SnapshotWriter writer;
+
+    for (size_t i = 0; i < proof.Size(); i++) writer.CollectStrings(proof.Clause(i));
+
+    for (char c : PROOF_MAGIC) writer.Byte(c);
+    writer.Byte(PROOF_VERSION);
+    writer.StringTable();
+
+    writer.Varint(proof.Size());
+    for (size_t i = 0; i < proof.Size(); i++)
+    {
+        writer.Varint(proof.Parent1(i) + 1);
+        writer.Varint(proof.Parent2(i) + 1);
+        writer.Varint(proof.SearchId(i));
+        writer.Term(proof.Clause(i));
+    }
+
+    return writer.Take();
+}
+
+std::unique_ptr<ProofDag> DeserializeProof(const char *data, size_t size)
+{
+    SnapshotReader reader(data, size);
+    std::vector<Formula*> clauses;
+    std::vector<int32_t>  parents;
+    std::vector<int32_t>  search_ids;
+
+    try
+    {
+        for (char c : PROOF_MAGIC) {
+            if (reader.Byte() != (unsigned char)c) {
+                throw std::runtime_error("Not a serialized proof");
+            }
+        }
+        if (reader.Byte() != PROOF_VERSION) {
+            throw std::runtime_error("Unsupported proof version");
+        }
+
+        reader.StringTable();
+
+        size_t count = reader.Count();
+        for (size_t i = 0; i < count; i++)
+        {
+            int parent1 = int(reader.Varint()) - 1;
+            int parent2 = int(reader.Varint()) - 1;
+            if (parent1 >= (int)i || parent2 >= (int)i || (parent1 < 0) != (parent2 < 0)) {
+                throw std::runtime_error("Corrupted proof");
+            }
+
+            parents.push_back(parent1);
+            parents.push_back(parent2);
+            search_ids.push_back(reader.Varint());
+            clauses.push_back(reader.Term());
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+        for (Formula *f : clauses) DeleteFormula(f);
+        throw;
+    }
+
+    return std::make_unique<ProofDag>(std::move(clauses), std::move(parents), std::move(search_ids));
+}
+
+} // namespace rzlogic
@@ -0,0 +1,180 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace rzlogic {
+
+static const size_t NO_QUEUE = static_cast<size_t>(-1);
+
+// queue of the pool the current thread works for
+static thread_local ThreadPool *current_pool = nullptr;
+static thread_local size_t      current_queue = NO_QUEUE;
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    for (size_t i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Push(size_t queue_idx, std::function<void()> task)
+{
+    // counted before it becomes visible, so a thief never takes pending below zero
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(queues[queue_idx]->mutex);
+        queues[queue_idx]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake.notify_one();
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+    // a std::function has to be copyable, the packaged task is not
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+
+    Enqueue([packaged] { (*packaged)(); });
+    return result;
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    size_t queue_idx = (current_pool == this) ? current_queue
+                                              : next_queue++ % queues.size();
+    Push(queue_idx, std::move(task));
+}
+
+bool ThreadPool::TryRunTask(size_t queue_idx)
+{
+    std::function<void()> task;
+
+    if (queue_idx != NO_QUEUE)
+    {
+        WorkQueue &own = *queues[queue_idx];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    size_t start = (queue_idx == NO_QUEUE) ? 0 : queue_idx + 1;
+    for (size_t i = 0; !task && i < queues.size(); i++)
+    {
+        WorkQueue &victim = *queues[(start + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+
+    pending--;
+    task();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t queue_idx)
+{
+    current_pool  = this;
+    current_queue = queue_idx;
+
+    while (true)
+    {
+        if (TryRunTask(queue_idx)) continue;
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait(lock, [this] { return stopping || pending > 0; });
+        if (stopping && pending == 0) return;
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &func)
+{
+    if (count == 0) return;
+
+    if (workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; i++) func(i);
+        return;
+    }
+
+    struct State
+    {
+        std::mutex              mutex;
+        std::condition_variable done;
+        size_t                  remaining;
+        std::exception_ptr      error;
+    };
+
+    size_t chunks = std::min(count, workers.size() * 4);
+    auto state = std::make_shared<State>();
+    state->remaining = chunks;
+
+    for (size_t c = 0; c < chunks; c++)
+    {
+        size_t begin = c * count / chunks;
+        size_t end   = (c + 1) * count / chunks;
+
+        Enqueue([state, &func, begin, end] {
+            std::exception_ptr error;
+            try {
+                for (size_t i = begin; i < end; i++) func(i);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) state->error = error;
+            if (--state->remaining == 0) state->done.notify_all();
+        });
+    }
+
+    size_t own_queue = (current_pool == this) ? current_queue : NO_QUEUE;
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->remaining == 0) break;
+        }
+
+        if (TryRunTask(own_queue)) continue;
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait_for(lock, std::chrono::milliseconds(1), [&state] { return state->remaining == 0; });
+    }
+
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace rzlogic
@@ -0,0 +1,257 @@
+#include "tokenizer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RZLOGIC_SCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace rzlogic {
+
+// one bit per byte of a block
+struct BlockMasks
+{
+    uint64_t ident  = 0;
+    uint64_t space  = 0;
+    uint64_t lparen = 0;
+    uint64_t rparen = 0;
+    uint64_t hash   = 0;
+};
+
+static const size_t kBlockSize = 64;
+static const size_t kBatchSize = 256;
+
+enum : uint8_t
+{
+    CLASS_IDENT  = 1,
+    CLASS_SPACE  = 2,
+    CLASS_LPAREN = 4,
+    CLASS_RPAREN = 8,
+    CLASS_HASH   = 16
+};
+
+// the isalnum and isspace of the C locale, bytes past ASCII are neither
+struct ClassTable
+{
+    uint8_t classes[256] = {};
+
+    ClassTable()
+    {
+        for (int c = '0'; c <= '9'; c++) classes[c] = CLASS_IDENT;
+        for (int c = 'a'; c <= 'z'; c++) classes[c] = CLASS_IDENT;
+        for (int c = 'A'; c <= 'Z'; c++) classes[c] = CLASS_IDENT;
+        for (int c : {' ', '\t', '\n', '\v', '\f', '\r'}) classes[c] = CLASS_SPACE;
+        classes['('] = CLASS_LPAREN;
+        classes[')'] = CLASS_RPAREN;
+        classes['#'] = CLASS_HASH;
+    }
+};
+
+static const ClassTable class_table;
+
+static void ClassifyScalar(const char *block, BlockMasks &m)
+{
+    for (size_t i = 0; i < kBlockSize; i++)
+    {
+        uint64_t c = class_table.classes[(unsigned char)block[i]];
+        m.ident  |= (c & 1) << i;
+        m.space  |= ((c >> 1) & 1) << i;
+        m.lparen |= ((c >> 2) & 1) << i;
+        m.rparen |= ((c >> 3) & 1) << i;
+        m.hash   |= ((c >> 4) & 1) << i;
+    }
+}
+
+#ifdef RZLOGIC_SCAN_X86
+
+// lo <= c <= lo + count as unsigned bytes
+__attribute__((target("sse2"))) static inline __m128i InRange128(__m128i c, char lo, char count)
+{
+    __m128i t = _mm_sub_epi8(c, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(count)), t);
+}
+
+__attribute__((target("sse2"))) static inline uint64_t Mask128(__m128i m)
+{
+    return (uint16_t)_mm_movemask_epi8(m);
+}
+
+__attribute__((target("sse2"))) static void ClassifySse2(const char *block, BlockMasks &m)
+{
+    for (size_t i = 0; i < kBlockSize; i += 16)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i*)(block + i));
+
+        // letters are the lower case ones with bit 5 set
+        __m128i ident = _mm_or_si128(InRange128(c, '0', 9), InRange128(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 25));
+        __m128i space = _mm_or_si128(InRange128(c, '\t', 4), _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')));
+
+        m.ident  |= Mask128(ident) << i;
+        m.space  |= Mask128(space) << i;
+        m.lparen |= Mask128(_mm_cmpeq_epi8(c, _mm_set1_epi8('('))) << i;
+        m.rparen |= Mask128(_mm_cmpeq_epi8(c, _mm_set1_epi8(')'))) << i;
+        m.hash   |= Mask128(_mm_cmpeq_epi8(c, _mm_set1_epi8('#'))) << i;
+    }
+}
+
+__attribute__((target("avx2"))) static inline __m256i InRange256(__m256i c, char lo, char count)
+{
+    __m256i t = _mm256_sub_epi8(c, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(count)), t);
+}
+
+__attribute__((target("avx2"))) static inline uint64_t Mask256(__m256i m)
+{
+    return (uint32_t)_mm256_movemask_epi8(m);
+}
+
+__attribute__((target("avx2"))) static void ClassifyAvx2(const char *block, BlockMasks &m)
+{
+    for (size_t i = 0; i < kBlockSize; i += 32)
+    {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(block + i));
+
+        __m256i ident = _mm256_or_si256(InRange256(c, '0', 9),
+                                        InRange256(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), 'a', 25));
+        __m256i space = _mm256_or_si256(InRange256(c, '\t', 4), _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')));
+
+        m.ident  |= Mask256(ident) << i;
+        m.space  |= Mask256(space) << i;
+        m.lparen |= Mask256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('('))) << i;
+        m.rparen |= Mask256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(')'))) << i;
+        m.hash   |= Mask256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('#'))) << i;
+    }
+}
+
+#endif
+
+ScanKernel BestScanKernel()
+{
+    static const ScanKernel best = []() {
+#ifdef RZLOGIC_SCAN_X86
+        if (__builtin_cpu_supports("avx2")) return ScanKernel::AVX2;
+        if (__builtin_cpu_supports("sse2")) return ScanKernel::SSE2;
+#endif
+        return ScanKernel::SCALAR;
+    }();
+    return best;
+}
+
+const char *ScanKernelName(ScanKernel kernel)
+{
+    switch (kernel) {
+    case ScanKernel::SCALAR: return "scalar";
+    case ScanKernel::SSE2:   return "sse2";
+    case ScanKernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+Tokenizer::Tokenizer(const char *data, size_t size, bool comments, ScanKernel kernel)
+    : data(data), size(size), comments(comments), kernel(kernel)
+{
+    // a kernel the CPU lacks would fault, fall back to what it has
+    if (kernel > BestScanKernel()) this->kernel = BestScanKernel();
+    // there are at most as many tokens as bytes, short inputs are common
+    batch.reserve(std::min(kBatchSize + kBlockSize, size) + 1);
+}
+
+void Tokenizer::ScanBlock()
+{
+    // the rest of the block is a comment
+    if (skip_until >= pos + kBlockSize)
+    {
+        carry = 0;
+        pos += kBlockSize;
+        return;
+    }
+
+    // the last block is padded with white space
+    const char *block = data + pos;
+    char tail[kBlockSize];
+    if (size - pos < kBlockSize)
+    {
+        memset(tail, ' ', kBlockSize);
+        memcpy(tail, block, size - pos);
+        block = tail;
+    }
+
+    BlockMasks m;
+    switch (kernel) {
+#ifdef RZLOGIC_SCAN_X86
+    case ScanKernel::AVX2: ClassifyAvx2(block, m); break;
+    case ScanKernel::SSE2: ClassifySse2(block, m); break;
+#endif
+    default: ClassifyScalar(block, m);
+    }
+
+    if (!comments) m.hash = 0;
+
+    // an identifier starts at a letter or digit after something else and
+    // ends at the first byte past it
+    uint64_t shifted = (m.ident << 1) | carry;
+    uint64_t starts  = m.ident & ~shifted;
+    uint64_t ends    = ~m.ident & shifted;
+    uint64_t invalid = ~(m.ident | m.space | m.lparen | m.rparen | m.hash);
+    carry = m.ident >> 63;
+
+    uint64_t events = starts | ends | m.lparen | m.rparen | m.hash | invalid;
+    if (skip_until > pos) events &= ~0ull << (skip_until - pos);
+
+    while (events)
+    {
+        unsigned    i   = __builtin_ctzll(events);
+        uint64_t    bit = 1ull << i;
+        const char *p   = data + pos + i;
+        events &= events - 1;
+
+        // an identifier can end where the next token starts
+        if (ends & bit)
+        {
+            batch.push_back({std::string_view(open, p - open), TokenType::IDENTIFIER});
+            open = nullptr;
+        }
+
+        if (starts & bit) {
+            open = p;
+        }
+        else if (m.lparen & bit) {
+            batch.push_back({std::string_view(p, 1), TokenType::LPAREN});
+        }
+        else if (m.rparen & bit) {
+            batch.push_back({std::string_view(p, 1), TokenType::RPAREN});
+        }
+        else if (m.hash & bit)
+        {
+            const char *newline = (const char*)memchr(p, '\n', data + size - p);
+            skip_until = newline ? newline - data + 1 : size + kBlockSize;
+            if (skip_until >= pos + kBlockSize) break;
+            events &= ~0ull << (skip_until - pos);
+        }
+        else if (invalid & bit) {
+            batch.push_back({std::string_view(p, 1), TokenType::INVALID});
+        }
+    }
+
+    pos += kBlockSize;
+}
+
+void Tokenizer::Fill()
+{
+    batch.clear();
+    index = 0;
+
+    while (pos < size && batch.size() < kBatchSize) ScanBlock();
+
+    if (pos >= size)
+    {
+        if (open) {
+            batch.push_back({std::string_view(open, data + size - open), TokenType::IDENTIFIER});
+            open = nullptr;
+        }
+        batch.push_back({std::string_view(data + size, 0), TokenType::END});
+    }
+}
+
+} // namespace rzlogic
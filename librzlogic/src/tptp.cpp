@@ -0,0 +1,433 @@
+#include "tptp.hpp"
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace rzlogic {
+
+static const size_t MAX_INCLUDE_DEPTH = 64;
+
+static Formula *Binary(FormulaType type, Formula *f1, Formula *f2)
+{
+    Formula *f = new Formula(type);
+    f->children = {f1, f2};
+    return f;
+}
+
+static Formula *Negated(Formula *f)
+{
+    Formula *negated = new Formula(FormulaType::NOT);
+    negated->children.push_back(f);
+    return negated;
+}
+
+TptpReader::TptpReader(const std::string &path, const std::string &include_dir) : include_dir(include_dir)
+{
+    OpenFile(path, {});
+}
+
+TptpReader::TptpReader(std::istream &in, const std::string &name, const std::string &include_dir)
+    : include_dir(include_dir)
+{
+    Source source;
+    source.in   = &in;
+    source.name = name;
+    sources.push_back(std::move(source));
+}
+
+void TptpReader::OpenFile(const std::string &path, const std::set<std::string> &selection)
+{
+    auto file = std::make_unique<std::ifstream>(path, std::ios::binary);
+    if (!*file) {
+        if (sources.empty()) throw std::runtime_error("Cannot open " + path);
+        Error("Cannot open " + path);
+    }
+
+    Source source;
+    source.in        = file.get();
+    source.file      = std::move(file);
+    source.name      = path;
+    source.directory = std::filesystem::path(path).parent_path().string();
+    source.selection = selection;
+    sources.push_back(std::move(source));
+}
+
+void TptpReader::Error(const std::string &message) const
+{
+    const Source &source = sources.back();
+    throw std::runtime_error(source.name + ":" + std::to_string(source.line) + ": " + message);
+}
+
+void TptpReader::ParseToken()
+{
+    Source &source = sources.back();
+    std::streambuf *buf = source.in->rdbuf();
+
+    auto get = [&]()
+    {
+        int c = buf->sbumpc();
+        if (c == '\n') source.line++;
+        return c;
+    };
+
+    token_str.clear();
+
+    // white space and comments
+    for (;;)
+    {
+        int c = buf->sgetc();
+        if (c != EOF && isspace(c)) {
+            get();
+        }
+        else if (c == '%') {
+            while (c != EOF && c != '\n') c = get();
+        }
+        else if (c == '/') {
+            get();
+            if (buf->sgetc() != '*') Error("Expected '*' after '/'");
+            get();
+
+            int prev = 0;
+            for (c = get(); c != EOF && !(prev == '*' && c == '/'); c = get()) prev = c;
+            if (c == EOF) Error("Unterminated comment");
+        }
+        else {
+            break;
+        }
+    }
+
+    int c = get();
+    switch (c) {
+    case EOF: token_type = TokenType::END; return;
+    case '(': token_type = TokenType::LPAREN; return;
+    case ')': token_type = TokenType::RPAREN; return;
+    case '[': token_type = TokenType::LBRACKET; return;
+    case ']': token_type = TokenType::RBRACKET; return;
+    case ',': token_type = TokenType::COMMA; return;
+    case '.': token_type = TokenType::DOT; return;
+    case ':': token_type = TokenType::COLON; return;
+
+    case '&': case '|': case '?':
+        token_type = TokenType::OPERATOR;
+        token_str  = char(c);
+        return;
+
+    case '~': case '!': case '=': case '<':
+        token_type = TokenType::OPERATOR;
+        token_str  = char(c);
+
+        // the longest of ~ ~| ~& ! != = => <= <=> <~>
+        if ((c == '~' && (buf->sgetc() == '|' || buf->sgetc() == '&')) ||
+            (c == '!' && buf->sgetc() == '=') ||
+            (c == '=' && buf->sgetc() == '>'))
+        {
+            token_str += char(get());
+        }
+        else if (c == '<')
+        {
+            if (buf->sgetc() != '=' && buf->sgetc() != '~') Error("Unknown operator <");
+            token_str += char(get());
+
+            if (buf->sgetc() == '>') token_str += char(get());
+            else if (token_str == "<~") Error("Unknown operator <~");
+        }
+        return;
+
+    case '\'': case '"':
+        token_type = (c == '\'') ? TokenType::LOWER_WORD : TokenType::DISTINCT;
+        for (int quote = c; (c = get()) != quote; )
+        {
+            if (c == '\\') c = get();
+            if (c == EOF) Error("Unterminated quoted name");
+            token_str += char(c);
+        }
+        if (token_type == TokenType::DISTINCT) token_str = '"' + token_str + '"';
+        return;
+    }
+
+    if (c == '$' || isalnum(c) || c == '+' || c == '-')
+    {
+        token_str = char(c);
+        while (buf->sgetc() != EOF && (isalnum(buf->sgetc()) || buf->sgetc() == '_' ||
+                                       (isdigit(c) && (buf->sgetc() == '/' || buf->sgetc() == '.'))))
+        {
+            token_str += char(get());
+        }
+
+        if (c == '$') token_type = TokenType::DOLLAR_WORD;
+        else if (isdigit(c) || c == '+' || c == '-') token_type = TokenType::NUMBER;
+        else if (isupper(c)) token_type = TokenType::UPPER_WORD;
+        else token_type = TokenType::LOWER_WORD;
+        return;
+    }
+
+    Error(std::string("Unexpected character '") + char(c) + "'");
+}
+
+void TptpReader::Expect(TokenType type, const char *what)
+{
+    if (token_type != type) Error(std::string("Expected ") + what);
+    ParseToken();
+}
+
+Formula *TptpReader::ParseTerm()
+{
+    if (token_type == TokenType::UPPER_WORD)
+    {
+        Formula *f = new Formula(FormulaType::VARIABLE, token_str);
+        ParseToken();
+        return f;
+    }
+    if (token_type == TokenType::NUMBER || token_type == TokenType::DISTINCT)
+    {
+        Formula *f = new Formula(FormulaType::CONSTANT, token_str);
+        ParseToken();
+        return f;
+    }
+    if (token_type != TokenType::LOWER_WORD) Error("Expected a term");
+
+    FormulaPtr f(new Formula(FormulaType::CONSTANT, token_str));
+    ParseToken();
+
+    if (token_type == TokenType::LPAREN)
+    {
+        f->type = FormulaType::FUNCTION;
+        do {
+            ParseToken();
+            f->children.push_back(ParseTerm());
+        } while (token_type == TokenType::COMMA);
+        Expect(TokenType::RPAREN, "')' after arguments");
+    }
+    return f.release();
+}
+
+Formula *TptpReader::ParseAtom()
+{
+    if (token_type == TokenType::DOLLAR_WORD) Error(token_str + " is not supported");
+
+    FormulaPtr left(ParseTerm());
+    if (token_type == TokenType::OPERATOR && (token_str == "=" || token_str == "!="))
+    {
+        bool negated = (token_str == "!=");
+        ParseToken();
+
+        FormulaPtr equality(new Formula(FormulaType::PREDICATE, "="));
+        equality->children.push_back(left.release());
+        equality->children.push_back(ParseTerm());
+        return negated ? Negated(equality.release()) : equality.release();
+    }
+
+    if (left->type == FormulaType::VARIABLE) Error("Expected a predicate");
+    left->type = FormulaType::PREDICATE;
+    return left.release();
+}
+
+Formula *TptpReader::ParseUnitary()
+{
+    if (token_type == TokenType::LPAREN)
+    {
+        ParseToken();
+        FormulaPtr f(ParseFormula());
+        Expect(TokenType::RPAREN, "')'");
+        return f.release();
+    }
+
+    if (token_type == TokenType::OPERATOR && token_str == "~")
+    {
+        ParseToken();
+        return Negated(ParseUnitary());
+    }
+
+    if (token_type == TokenType::OPERATOR && (token_str == "!" || token_str == "?"))
+    {
+        FormulaType type = (token_str == "!") ? FormulaType::FORALL : FormulaType::EXISTS;
+        ParseToken();
+
+        std::vector<std::string> vars;
+        if (token_type != TokenType::LBRACKET) Error("Expected '[' after quantifier");
+        do {
+            ParseToken();
+            if (token_type != TokenType::UPPER_WORD) Error("Expected a variable");
+            vars.push_back(token_str);
+            ParseToken();
+        } while (token_type == TokenType::COMMA);
+        Expect(TokenType::RBRACKET, "']' after variables");
+        Expect(TokenType::COLON, "':' after variables");
+
+        Formula *f = ParseUnitary();
+        for (size_t i = vars.size(); i-- > 0; )
+        {
+            Formula *quantifier = new Formula(type, vars[i]);
+            quantifier->children.push_back(f);
+            f = quantifier;
+        }
+        return f;
+    }
+
+    return ParseAtom();
+}
+
+Formula *TptpReader::ParseFormula()
+{
+    FormulaPtr left(ParseUnitary());
+    if (token_type != TokenType::OPERATOR) return left.release();
+
+    std::string op = token_str;
+
+    // & and | chain, the rest takes two operands
+    if (op == "&" || op == "|")
+    {
+        FormulaType type = (op == "&") ? FormulaType::AND : FormulaType::OR;
+        while (token_type == TokenType::OPERATOR && token_str == op)
+        {
+            ParseToken();
+            Formula *right = ParseUnitary();
+            left.reset(Binary(type, left.release(), right));
+        }
+        return left.release();
+    }
+
+    ParseToken();
+    FormulaPtr right(ParseUnitary());
+
+    if (op == "=>") return Binary(FormulaType::IMPLIES, left.release(), right.release());
+    if (op == "<=") return Binary(FormulaType::IMPLIES, right.release(), left.release());
+    if (op == "~|") return Negated(Binary(FormulaType::OR, left.release(), right.release()));
+    if (op == "~&") return Negated(Binary(FormulaType::AND, left.release(), right.release()));
+
+    if (op == "<=>" || op == "<~>")
+    {
+        Formula *forward  = Binary(FormulaType::IMPLIES, CloneFormula(left.get()), CloneFormula(right.get()));
+        Formula *backward = Binary(FormulaType::IMPLIES, right.release(), left.release());
+        Formula *f = Binary(FormulaType::AND, forward, backward);
+        return (op == "<=>") ? f : Negated(f);
+    }
+
+    Error("Unexpected operator " + op);
+}
+
+void TptpReader::SkipAnnotations()
+{
+    // general terms up to the ')' closing the statement
+    int depth = 0;
+    while (depth > 0 || token_type != TokenType::RPAREN)
+    {
+        if (token_type == TokenType::END) Error("Unexpected end of file");
+        if (token_type == TokenType::LPAREN || token_type == TokenType::LBRACKET) depth++;
+        if (token_type == TokenType::RPAREN || token_type == TokenType::RBRACKET) depth--;
+        ParseToken();
+    }
+}
+
+void TptpReader::Include()
+{
+    ParseToken();
+    Expect(TokenType::LPAREN, "'(' after include");
+    if (token_type != TokenType::LOWER_WORD) Error("Expected a file name");
+    std::string file = token_str;
+    ParseToken();
+
+    std::set<std::string> selection = sources.back().selection;
+    if (token_type == TokenType::COMMA)
+    {
+        ParseToken();
+        if (token_type != TokenType::LBRACKET) Error("Expected '[' before formula names");
+
+        selection.clear();
+        do {
+            ParseToken();
+            if (token_type != TokenType::LOWER_WORD && token_type != TokenType::NUMBER) Error("Expected a formula name");
+            selection.insert(token_str);
+            ParseToken();
+        } while (token_type == TokenType::COMMA);
+        Expect(TokenType::RBRACKET, "']' after formula names");
+    }
+    Expect(TokenType::RPAREN, "')' after include");
+    if (token_type != TokenType::DOT) Error("Expected '.' after include");
+
+    if (sources.size() >= MAX_INCLUDE_DEPTH) Error("Includes nested too deep");
+
+    namespace fs = std::filesystem;
+    std::string path = (fs::path(sources.back().directory) / file).string();
+    if (!include_dir.empty() && fs::exists(fs::path(include_dir) / file)) {
+        path = (fs::path(include_dir) / file).string();
+    }
+    OpenFile(path, selection);
+}
+
+bool TptpReader::Next(TptpFormula &formula)
+{
+    while (!sources.empty())
+    {
+        ParseToken();
+        if (token_type == TokenType::END)
+        {
+            sources.pop_back();
+            continue;
+        }
+
+        if (token_type != TokenType::LOWER_WORD) Error("Expected cnf, fof or include");
+        std::string kind = token_str;
+
+        if (kind == "include")
+        {
+            Include();
+            continue;
+        }
+        if (kind != "cnf" && kind != "fof") Error(kind + " statements are not supported");
+
+        ParseToken();
+        Expect(TokenType::LPAREN, "'('");
+        if (token_type != TokenType::LOWER_WORD && token_type != TokenType::NUMBER) Error("Expected a formula name");
+        std::string name = token_str;
+        ParseToken();
+        Expect(TokenType::COMMA, "',' after the name");
+
+        if (token_type != TokenType::LOWER_WORD) Error("Expected a role");
+        std::string role = token_str;
+        ParseToken();
+        Expect(TokenType::COMMA, "',' after the role");
+
+        FormulaPtr f(ParseFormula());
+        if (token_type == TokenType::COMMA) SkipAnnotations();
+        Expect(TokenType::RPAREN, "')' after the formula");
+
+        // the next statement may be in another file, nothing is read past the dot
+        if (token_type != TokenType::DOT) Error("Expected '.' after the statement");
+
+        const std::set<std::string> &selection = sources.back().selection;
+        if (!selection.empty() && !selection.count(name)) continue;
+
+        formula.name    = name;
+        formula.role    = role;
+        formula.formula = f.release();
+        return true;
+    }
+    return false;
+}
+
+void ReadTptpProblem(const std::string &path, std::vector<Formula*> &premises, const std::string &include_dir)
+{
+    size_t old_size = premises.size();
+
+    try
+    {
+        TptpReader reader(path, include_dir);
+        TptpFormula formula;
+
+        while (reader.Next(formula))
+        {
+            if (formula.role == "conjecture") formula.formula = Negated(formula.formula);
+            premises.push_back(formula.formula);
+        }
+    }
+    catch (...)
+    {
+        for (size_t i = old_size; i < premises.size(); i++) DeleteFormula(premises[i]);
+        premises.resize(old_size);
+        throw;
+    }
+}
+
+} // namespace rzlogic
@@ -0,0 +1,201 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace rzlogic {
+
+#ifdef RZLOGIC_TRACING
+
+std::atomic<bool> trace_recording{false};
+
+static const size_t kChunkEvents = 4096;
+
+// Events are never moved once written, so a reader can walk the chunks
+// while their thread keeps appending. count publishes the written ones.
+struct TraceChunk
+{
+    TraceEvent               events[kChunkEvents];
+    std::atomic<size_t>      count{0};
+    std::atomic<TraceChunk*> next{nullptr};
+};
+
+// written only by its thread, outlives it in the registry until the next
+// StartTracing, so WriteTrace still sees the events of finished threads
+struct TraceBuffer
+{
+    int         tid;
+    TraceChunk  head;
+    TraceChunk *tail = &head;
+
+    explicit TraceBuffer(int tid) : tid(tid) {}
+    ~TraceBuffer() { Reset(); }
+
+    void Append(const TraceEvent &event)
+    {
+        size_t count = tail->count.load(std::memory_order_relaxed);
+        if (count == kChunkEvents)
+        {
+            TraceChunk *chunk = new TraceChunk;
+            tail->next.store(chunk, std::memory_order_release);
+            tail  = chunk;
+            count = 0;
+        }
+
+        tail->events[count] = event;
+        tail->count.store(count + 1, std::memory_order_release);
+    }
+
+    void Reset()
+    {
+        TraceChunk *chunk = head.next.exchange(nullptr);
+        while (chunk)
+        {
+            TraceChunk *next = chunk->next.load();
+            delete chunk;
+            chunk = next;
+        }
+        head.count = 0;
+        tail = &head;
+    }
+};
+
+struct TraceRegistry
+{
+    std::mutex                                mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    int64_t                                   epoch    = 0;
+    int                                       next_tid = 1;
+};
+
+static TraceRegistry &Registry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+int64_t TraceNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RecordTraceEvent(const TraceEvent &event)
+{
+    // the registry is locked once per thread, on its first event
+    static thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer)
+    {
+        TraceRegistry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffer = std::make_shared<TraceBuffer>(registry.next_tid++);
+        registry.buffers.push_back(buffer);
+    }
+
+    buffer->Append(event);
+}
+
+bool TracingAvailable()
+{
+    return true;
+}
+
+void StartTracing()
+{
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // only the registry holds the buffers of threads that have exited
+    auto &buffers = registry.buffers;
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                 [](const std::shared_ptr<TraceBuffer> &buffer) { return buffer.use_count() == 1; }),
+                  buffers.end());
+
+    for (auto &buffer : buffers) buffer->Reset();
+    registry.epoch = TraceNow();
+    trace_recording = true;
+}
+
+void StopTracing()
+{
+    trace_recording = false;
+}
+
+void WriteTrace(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open trace " + path);
+    }
+
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // microseconds, as the format expects
+    auto micros = [&registry](int64_t ns) { return (ns - registry.epoch) / 1000.0; };
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"rzlogic\"}}");
+
+    for (auto &buffer : registry.buffers)
+    {
+        bool named = false;
+
+        for (TraceChunk *chunk = &buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            size_t count = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++)
+            {
+                const TraceEvent &event = chunk->events[i];
+
+                if (!named)
+                {
+                    fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                                  "\"args\": {\"name\": \"thread %d\"}}", buffer->tid, buffer->tid);
+                    named = true;
+                }
+
+                if (event.phase == 'X')
+                {
+                    fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                            event.name, buffer->tid, micros(event.start), event.duration / 1000.0);
+                }
+                else
+                {
+                    fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, "
+                                  "\"args\": {\"value\": %lld}}",
+                            event.name, buffer->tid, micros(event.start), (long long)event.value);
+                }
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    bool failed = ferror(file);
+    if (fclose(file) != 0 || failed) {
+        throw std::runtime_error("Cannot write trace " + path);
+    }
+}
+
+#else
+
+bool TracingAvailable()
+{
+    return false;
+}
+
+void StartTracing() {}
+void StopTracing() {}
+
+void WriteTrace(const std::string &path)
+{
+    throw std::runtime_error("Cannot write trace " + path + ": built without RZLOGIC_TRACING");
+}
+
+#endif
+
+} // namespace rzlogic
@@ -26,3 +26,16 @@ TEST(FormsTest, NormalizeFormulaTest)
     ASSERT_EQ(FormulaAsString(f2), "(forall x (forall y (forall z (or (not (and (R x y) (R y z))) (R x z)))))");
     DeleteFormula(f2);
 }
+
+TEST(FormsTest, NestedDistributionTest)
+{
+    Formula *f = Or(And(Predicate("A", {Const("c")}), Predicate("B", {Const("c")})),
+                    And(Predicate("C", {Const("c")}), Predicate("D", {Const("c")})));
+
+    MakeConjunctiveNormalForm(f);
+
+    // the disjunctions left under the first conjunction are distributed too
+    ASSERT_EQ(FormulaAsString(f), "(and (and (or (A c) (C c)) (or (B c) (C c))) (and (or (A c) (D c)) (or (B c) (D c))))");
+
+    DeleteFormula(f);
+}
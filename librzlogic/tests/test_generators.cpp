@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "generators.hpp"
+#include "prover.hpp"
+
+using namespace rzlogic;
+
+static ProofResult ProveGenerated(const GeneratedProblem &problem, std::vector<Formula*> &clauses)
+{
+    ClausifyPremises(problem.premises, clauses);
+
+    ResolutionOptions options;
+    options.limits.max_generated = 20000;
+
+    std::vector<ResolutionStepInfo> history;
+    ProofResult result = MakeResolution(clauses, history, options);
+
+    DeleteHistory(history);
+    return result;
+}
+
+static void DeleteClauses(std::vector<Formula*> &clauses)
+{
+    for (Formula *f : clauses) DeleteFormula(f);
+    clauses.clear();
+}
+
+TEST(GeneratorsTest, ExpectedResultsTest)
+{
+    // Unificate gives up on a clause pair as soon as two literals of one
+    // predicate do not unify, so pigeonhole is only checked for its shape
+    std::vector<GeneratedProblem> problems = {
+        ImplicationChainProblem(1), ImplicationChainProblem(8),
+        SkolemNestingProblem(1), SkolemNestingProblem(3),
+        DistributionProblem(1), DistributionProblem(4),
+        FactBaseProblem(1, 1), FactBaseProblem(20, 3),
+    };
+
+    for (const GeneratedProblem &problem : problems)
+    {
+        std::vector<Formula*> clauses;
+        ASSERT_EQ(ProveGenerated(problem, clauses), problem.expected) << problem.name;
+        DeleteClauses(clauses);
+    }
+}
+
+TEST(GeneratorsTest, SizesTest)
+{
+    std::vector<Formula*> clauses;
+
+    // 4 pigeons: 4 placements and 3 holes * 6 pairs
+    GeneratedProblem pigeonhole = PigeonholeProblem(3);
+    ClausifyPremises(pigeonhole.premises, clauses);
+    ASSERT_EQ(clauses.size(), 4 + 3 * 6);
+    DeleteClauses(clauses);
+
+    // the disjunction alone turns into 2^width clauses
+    GeneratedProblem distribution = DistributionProblem(5);
+    ClausifyPremises({distribution.premises[0]}, clauses);
+    ASSERT_EQ(clauses.size(), 32);
+    DeleteClauses(clauses);
+
+    GeneratedProblem chain = ImplicationChainProblem(10);
+    ASSERT_EQ(chain.premises.size(), 12);
+    ASSERT_EQ(chain.premises.back(), "(not (P10 a))");
+
+    GeneratedProblem facts = FactBaseProblem(100, 5);
+    ASSERT_EQ(facts.premises.size(), 100 + 5 + 1);
+}
+
+TEST(GeneratorsTest, NonTerminatingTest)
+{
+    GeneratedProblem problem = NonTerminatingProblem(3);
+    ASSERT_EQ(problem.expected, ProofResult::UNKNOWN);
+
+    // satisfiable, no limit makes it provable
+    std::vector<Formula*> clauses;
+    ASSERT_NE(ProveGenerated(problem, clauses), ProofResult::PROVED);
+    DeleteClauses(clauses);
+}
+
+TEST(GeneratorsTest, FamiliesTest)
+{
+    for (const std::string &family : GeneratorFamilies())
+    {
+        GeneratedProblem problem = GenerateProblem(family, 2);
+        ASSERT_FALSE(problem.premises.empty()) << family;
+
+        std::vector<Formula*> clauses;
+        ASSERT_NO_THROW(ClausifyPremises(problem.premises, clauses)) << family;
+        DeleteClauses(clauses);
+    }
+
+    ASSERT_THROW(GenerateProblem("sudoku", 2), std::runtime_error);
+    ASSERT_THROW(GenerateProblem("chain", 0), std::runtime_error);
+}
@@ -28,4 +28,74 @@ TEST(ParserTest, BigFormulaTest)
     DeleteFormula(f1);
     //DeleteFormula(f2);
     //DeleteFormula(f3);
-}
\ No newline at end of file
+}
+
+static std::vector<std::string> StreamParse(const std::string &text)
+{
+    StreamParser parser(text.data(), text.size(), "facts.txt");
+    std::vector<std::string> formulas;
+    parser.Parse([&formulas](Formula *f) {
+        formulas.push_back(FormulaAsString(f));
+        DeleteFormula(f);
+    });
+    return formulas;
+}
+
+TEST(StreamParserTest, FormulasTest)
+{
+    std::string text = "# facts\n"
+                       "(Human alice)\t(Human bob)\n"
+                       "\n"
+                       "(forall x (implies (Human x)\n"
+                       "                   (Mortal x)))  # a rule\n"
+                       "(exists y (and (Love y (f y)) (not (Mortal y))))";
+
+    std::vector<std::string> formulas = StreamParse(text);
+    ASSERT_EQ(formulas.size(), 4);
+    ASSERT_EQ(formulas[0], "(Human alice)");
+    ASSERT_EQ(formulas[1], "(Human bob)");
+    ASSERT_EQ(formulas[2], "(forall x (implies (Human x) (Mortal x)))");
+    ASSERT_EQ(formulas[3], "(exists y (and (Love y (f y)) (not (Mortal y))))");
+
+    // the same trees as Parser
+    Formula *f = Parser("(forall x (implies (Human x) (Mortal x)))").Parse();
+    StreamParser parser(text.data(), text.size());
+    std::vector<Formula*> parsed;
+    parser.Parse([&](Formula *g) { parsed.push_back(g); });
+
+    // freed before asserting, a failure must not leak them
+    bool equal = parsed.size() == 4 && FormulasEqual(f, parsed[2]);
+    DeleteFormula(f);
+    for (Formula *g : parsed) DeleteFormula(g);
+    ASSERT_TRUE(equal);
+
+    // names but not variables are interned
+    ASSERT_TRUE(parser.Symbols().Contains("Human"));
+    ASSERT_TRUE(parser.Symbols().Contains("alice"));
+    ASSERT_TRUE(parser.Symbols().Contains("f"));
+    ASSERT_FALSE(parser.Symbols().Contains("x"));
+    ASSERT_EQ(parser.Symbols().Size(), 6);
+
+    ASSERT_TRUE(StreamParse("  # nothing\n").empty());
+}
+
+TEST(StreamParserTest, ErrorPositionTest)
+{
+    try
+    {
+        StreamParse("(P a)\n(Q b)\n  (R c\n");
+        FAIL();
+    }
+    catch (const std::runtime_error &e) {
+        ASSERT_STREQ(e.what(), "facts.txt:4:1: Expected identifier or '('");
+    }
+
+    try
+    {
+        StreamParse("(P a)\n(forall x (P x)) (Q b, c)");
+        FAIL();
+    }
+    catch (const std::runtime_error &e) {
+        ASSERT_STREQ(e.what(), "facts.txt:2:22: Unexpected character ','");
+    }
+}
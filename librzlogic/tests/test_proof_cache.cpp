@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "proof_cache.hpp"
+#include "utils.hpp"
+#include <filesystem>
+
+using namespace rzlogic;
+
+static CachedProof MakeCachedProof(ProofResult result, const std::string &resolvent)
+{
+    CachedProof proof;
+    proof.result = result;
+    proof.proof.emplace_back("(P a)", "(not (P a))", resolvent);
+    return proof;
+}
+
+TEST(ProofCacheTest, CanonicalKeyTest)
+{
+    std::vector<Formula*> clauses1 = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x"), Var("y")})),
+        Predicate("P", {Const("a")}),
+    };
+    // renamed variables, swapped clauses
+    std::vector<Formula*> clauses2 = {
+        Predicate("P", {Const("a")}),
+        Or(Not(Predicate("P", {Var("u")})), Predicate("Q", {Var("u"), Var("z")})),
+    };
+    // the same variable twice is a different problem
+    std::vector<Formula*> clauses3 = {
+        Predicate("P", {Const("a")}),
+        Or(Not(Predicate("P", {Var("u")})), Predicate("Q", {Var("u"), Var("u")})),
+    };
+
+    std::string key = CanonicalProblemKey(clauses1);
+    ASSERT_EQ(key, "(P a)\n(or (not (P _0)) (Q _0 _1))\n");
+    ASSERT_EQ(CanonicalProblemKey(clauses2), key);
+    ASSERT_NE(CanonicalProblemKey(clauses3), key);
+    ASSERT_EQ(HashProblemKey(CanonicalProblemKey(clauses2)), HashProblemKey(key));
+
+    for (auto *clauses : {&clauses1, &clauses2, &clauses3})
+    {
+        for (Formula *f : *clauses) DeleteFormula(f);
+    }
+}
+
+TEST(ProofCacheTest, RenamedProofTest)
+{
+    std::vector<Formula*> clauses1 = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("Q", {Const("a")})),
+    };
+    // renamed variables, reordered clauses
+    std::vector<Formula*> clauses2 = {
+        Not(Predicate("Q", {Const("a")})),
+        Predicate("P", {Const("a")}),
+        Or(Not(Predicate("P", {Var("u")})), Predicate("Q", {Var("u")})),
+    };
+
+    ProblemVariables variables1, variables2;
+    NumberProblemVariables(clauses1, variables1);
+    NumberProblemVariables(clauses2, variables2);
+    ASSERT_EQ(CanonicalProblemKey(clauses2) + variables2.pattern, CanonicalProblemKey(clauses1) + variables1.pattern);
+
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolution(clauses1, history, ResolutionOptions()), ProofResult::PROVED);
+
+    std::vector<ProofStepStrings> steps;
+    ASSERT_TRUE(CanonicalProofSteps(history, variables1, steps));
+    ASSERT_EQ(steps.size(), history.size());
+
+    // the steps of the first problem, in the names of the second
+    auto rename = [](Formula *f) {
+        std::string text = FormulaAsString(f);
+        for (size_t pos = text.find(" x)"); pos != std::string::npos; pos = text.find(" x)", pos)) text[pos + 1] = 'u';
+        return text;
+    };
+
+    std::vector<ProofStepStrings> renamed = RenameProofSteps(steps, variables2);
+    for (size_t i = 0; i < history.size(); i++)
+    {
+        ASSERT_EQ(std::get<0>(renamed[i]), rename(history[i].premise1));
+        ASSERT_EQ(std::get<1>(renamed[i]), rename(history[i].premise2));
+        ASSERT_EQ(std::get<2>(renamed[i]), rename(history[i].resolvent));
+    }
+    ASSERT_NE(std::get<0>(renamed[0]).find(" u)"), std::string::npos);
+
+    DeleteHistory(history);
+    for (auto *clauses : {&clauses1, &clauses2})
+    {
+        for (Formula *f : *clauses) DeleteFormula(f);
+    }
+}
+
+TEST(ProofCacheTest, SharedVariablesTest)
+{
+    // one key, but x is shared between the clauses of the first problem only
+    std::vector<Formula*> clauses1 = {Predicate("P", {Var("x")}), Predicate("Q", {Var("x")})};
+    std::vector<Formula*> clauses2 = {Predicate("P", {Var("x")}), Predicate("Q", {Var("y")})};
+
+    ProblemVariables variables1, variables2;
+    NumberProblemVariables(clauses1, variables1);
+    NumberProblemVariables(clauses2, variables2);
+
+    ASSERT_EQ(CanonicalProblemKey(clauses1), CanonicalProblemKey(clauses2));
+    ASSERT_NE(variables1.pattern, variables2.pattern);
+
+    for (auto *clauses : {&clauses1, &clauses2})
+    {
+        for (Formula *f : *clauses) DeleteFormula(f);
+    }
+}
+
+TEST(ProofCacheTest, LruTest)
+{
+    ProofCache cache(2);
+    CachedProof proof;
+
+    cache.Store("a", MakeCachedProof(ProofResult::PROVED, "□"));
+    cache.Store("b", MakeCachedProof(ProofResult::SATURATED, "(Q a)"));
+    ASSERT_TRUE(cache.Lookup("a", proof));
+
+    // "b" is the least recently used one now
+    cache.Store("c", MakeCachedProof(ProofResult::PROVED, "□"));
+    ASSERT_EQ(cache.Size(), 2);
+    ASSERT_FALSE(cache.Lookup("b", proof));
+    ASSERT_TRUE(cache.Lookup("c", proof));
+    ASSERT_TRUE(cache.Lookup("a", proof));
+    ASSERT_EQ(proof.result, ProofResult::PROVED);
+    ASSERT_EQ(std::get<2>(proof.proof[0]), "□");
+
+    // limits decide an unknown result, it is not worth keeping
+    cache.Store("d", MakeCachedProof(ProofResult::UNKNOWN, "(Q a)"));
+    ASSERT_FALSE(cache.Lookup("d", proof));
+
+    ASSERT_EQ(cache.Hits(), 3);
+    ASSERT_EQ(cache.Misses(), 2);
+}
+
+TEST(ProofCacheTest, DiskTierTest)
+{
+    std::string directory = testing::TempDir() + "rzlogic_cache";
+    std::filesystem::remove_all(directory);
+
+    std::string key = "(P a)\n(not (P a))\n";
+    {
+        ProofCache cache(16, directory);
+        cache.Store(key, MakeCachedProof(ProofResult::PROVED, "□"));
+    }
+
+    // a new cache, e.g. in another process, finds the entry on disk
+    ProofCache cache(16, directory);
+    CachedProof proof;
+
+    ASSERT_TRUE(cache.Lookup(key, proof));
+    ASSERT_EQ(proof.result, ProofResult::PROVED);
+    ASSERT_EQ(proof.proof.size(), 1);
+    ASSERT_EQ(std::get<0>(proof.proof[0]), "(P a)");
+    ASSERT_EQ(cache.Size(), 1);
+
+    ASSERT_FALSE(cache.Lookup("(Q a)\n", proof));
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "proof_log.hpp"
+#include "utils.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace rzlogic;
+using namespace std::string_literals;
+
+static std::vector<Formula*> LogPremises()
+{
+    return {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("Q", {Const("a")}))
+    };
+}
+
+TEST(ProofLogTest, ClauseAsTstpTest)
+{
+    Formula *f = Or(Not(Predicate("Love", {Var("x"), Function("f", {Const("a")})})), Predicate("q", {Const("B")}));
+
+    ASSERT_EQ(ClauseAsTstp(f), "~'Love'(X,f(a)) | q('B')");
+
+    Formula *empty = new Formula(FormulaType::EMPTY);
+    ASSERT_EQ(ClauseAsTstp(empty), "$false");
+
+    DeleteFormula(f);
+    DeleteFormula(empty);
+}
+
+TEST(ProofLogTest, TstpLogTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_proof.p";
+    std::vector<Formula*> premises = LogPremises();
+    std::vector<ResolutionStepInfo> history;
+
+    {
+        ProofLog log(path, ProofLogFormat::TSTP);
+        ResolutionOptions options;
+        options.log = &log;
+        ASSERT_EQ(MakeResolution(premises, history, options), ProofResult::PROVED);
+    }
+
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+
+    ASSERT_EQ(content.str().find("cnf(c0, axiom, (~'P'(X) | 'Q'(X)))."), 0);
+    ASSERT_NE(content.str().find("cnf(c1, axiom, ('P'(a)))."), std::string::npos);
+    ASSERT_NE(content.str().find("($false), inference(resolution, [status(thm)], ["), std::string::npos);
+
+    DeleteHistory(history);
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+TEST(ProofLogTest, BinaryLogTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_proof.bin";
+    std::vector<Formula*> premises = LogPremises();
+    std::vector<ResolutionStepInfo> history;
+
+    {
+        ProofLog log(path, ProofLogFormat::BINARY);
+        ResolutionOptions options;
+        options.log = &log;
+        ASSERT_EQ(MakeResolution(premises, history, options), ProofResult::PROVED);
+    }
+
+    std::vector<ProofLogRecord> records;
+    std::vector<std::string> clauses;
+    ReadProofLog(path, [&](const ProofLogRecord &record) {
+        records.push_back(record);
+        clauses.push_back(FormulaAsString(record.clause));
+    });
+
+    ASSERT_GE(records.size(), 4);
+    for (size_t i = 0; i < premises.size(); ++i)
+    {
+        ASSERT_EQ(records[i].id, (int)i);
+        ASSERT_EQ(records[i].rule, InferenceRule::INPUT);
+        ASSERT_EQ(records[i].parent1, -1);
+        ASSERT_EQ(clauses[i], FormulaAsString(premises[i]));
+    }
+
+    // the proof is a subset of the logged inferences
+    for (ResolutionStepInfo &step : history)
+    {
+        auto it = std::find_if(records.begin(), records.end(), [&step](const ProofLogRecord &r) {
+            return r.id == step.resolvent_id;
+        });
+        ASSERT_TRUE(it != records.end());
+        ASSERT_EQ(it->rule, InferenceRule::RESOLUTION);
+        ASSERT_EQ(it->parent1, step.premise1_id);
+        ASSERT_EQ(it->parent2, step.premise2_id);
+        ASSERT_EQ(clauses[it - records.begin()], FormulaAsString(step.resolvent));
+    }
+
+    DeleteHistory(history);
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+TEST(ProofLogTest, CorruptedBinaryLogTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_proof.bin";
+    std::vector<Formula*> premises = LogPremises();
+    std::vector<ResolutionStepInfo> history;
+
+    {
+        ProofLog log(path, ProofLogFormat::BINARY);
+        ResolutionOptions options;
+        options.log = &log;
+        ASSERT_EQ(MakeResolution(premises, history, options), ProofResult::PROVED);
+    }
+
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    auto read = [&path](const std::string &bytes)
+    {
+        std::ofstream(path, std::ios::binary) << bytes;
+        size_t records = 0;
+        ReadProofLog(path, [&records](const ProofLogRecord &) { records++; });
+        return records;
+    };
+
+    ASSERT_GT(read(data), 0);
+
+    // every prefix either ends between records or throws
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        try {
+            read(data.substr(0, size));
+        }
+        catch (const std::runtime_error &e) {
+            ASSERT_NE(std::string(e.what()).find(path), std::string::npos) << e.what();
+        }
+    }
+
+    // huge counts, overlong varints and unknown types and symbols
+    std::string header = data.substr(0, 5);
+    for (std::string record : {"\x01\xff\xff\xff\xff\x0f"s, "\x02"s + std::string(11, '\x80') + "\x01"s,
+                               "\x02\x00\x00\x00\x00\x01\x00\x63\x00\x00"s,
+                               "\x02\x00\x00\x00\x00\x01\x00\x08\x05\x00"s,
+                               "\x02\x00\x00\x00\x07\x00"s})
+    {
+        ASSERT_THROW(read(header + record), std::runtime_error);
+    }
+
+    DeleteHistory(history);
+    for (Formula *f : premises) DeleteFormula(f);
+}
@@ -0,0 +1,413 @@
+#include <gtest/gtest.h>
+#include "parser.hpp"
+#include "prover.hpp"
+#include "thread_pool.hpp"
+#include <fstream>
+#include <set>
+#include <thread>
+
+using namespace rzlogic;
+
+TEST(ProverTest, ClausifyPremisesTest)
+{
+    std::vector<Formula*> clauses;
+
+    ClausifyPremises({"(forall x (implies (H x) (M x)))", "(H a)", "(not (M a))"}, clauses);
+
+    ASSERT_EQ(clauses.size(), 3);
+    ASSERT_EQ(FormulaAsString(clauses[0]), "(or (not (H x)) (M x))");
+
+    // a broken premise leaves the clauses untouched
+    ASSERT_THROW(ClausifyPremises({"(P a)", "P a"}, clauses), std::runtime_error);
+    ASSERT_EQ(clauses.size(), 3);
+
+    for (Formula *f : clauses) DeleteFormula(f);
+}
+
+TEST(ProverTest, ClausifyPremiseFileTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_premises.txt";
+    std::ofstream(path) << "(forall x (implies (H x) (M x)))\n(H a) (not (M a))\n"
+                           "# the Skolem constant cannot be a name of the problem\n"
+                           "(exists y (M y))\n";
+
+    std::vector<Formula*> clauses;
+    ClausifyPremiseFile(path, clauses);
+
+    ASSERT_EQ(clauses.size(), 4);
+    ASSERT_EQ(FormulaAsString(clauses[0]), "(or (not (H x)) (M x))");
+    ASSERT_EQ(FormulaAsString(clauses[3]), "(M $a)");
+
+    std::ofstream(path) << "(H b)\n(H\n";
+    ASSERT_THROW(ClausifyPremiseFile(path, clauses), std::runtime_error);
+    ASSERT_EQ(clauses.size(), 4);
+
+    for (Formula *f : clauses) DeleteFormula(f);
+}
+
+static void AddConstants(Formula *f, std::set<std::string> &constants)
+{
+    if (f->type == FormulaType::CONSTANT) constants.insert(f->str);
+    for (Formula *child : f->children) AddConstants(child, constants);
+}
+
+TEST(ProverTest, ParallelClausifyTest)
+{
+    std::vector<std::string> premises;
+    for (int i = 0; i < 200; i++)
+    {
+        std::string p = "(P" + std::to_string(i) + " x)";
+        premises.push_back(i % 3 ? "(forall x (implies " + p + " (exists y (and (R x y) (Q y)))))"
+                                 : "(exists x (or " + p + " (and (Q x) (S x))))");
+    }
+
+    std::vector<Formula*> sequential, parallel;
+    ClausifyPremises(premises, sequential);
+
+    ThreadPool pool(4);
+    ClausifyPremises(premises, parallel, &pool);
+
+    // the same clauses in the same order, Skolem symbols are not reused
+    ASSERT_EQ(sequential.size(), parallel.size());
+    std::set<std::string> skolem_constants;
+    for (size_t i = 0; i < sequential.size(); i++)
+    {
+        ASSERT_EQ(FormulaAsString(sequential[i]), FormulaAsString(parallel[i]));
+        AddConstants(parallel[i], skolem_constants);
+    }
+    ASSERT_EQ(skolem_constants.size(), 67);
+
+    for (Formula *f : sequential) DeleteFormula(f);
+    for (Formula *f : parallel) DeleteFormula(f);
+    parallel.clear();
+
+    // the error of the first broken premise
+    premises[150] = "(P a";
+    premises[10] = "(P a) (Q b)";
+    try
+    {
+        ClausifyPremises(premises, parallel, &pool);
+        FAIL();
+    }
+    catch (const std::runtime_error &e) {
+        ASSERT_STREQ(e.what(), "Unexpected trailing characters");
+    }
+    ASSERT_TRUE(parallel.empty());
+}
+
+TEST(ProverTest, StatisticsTest)
+{
+    ProofStatistics statistics;
+    std::vector<Formula*> clauses;
+    ClausifyPremises({"(forall x (implies (P x) (Q x)))", "(forall y (implies (Q y) (R y)))",
+                      "(exists z (P z))", "(not (R a))", "(not (R a1))"}, clauses, nullptr, &statistics);
+
+    ASSERT_GT(statistics.parse_seconds, 0);
+    ASSERT_GT(statistics.skolem_seconds, 0);
+    size_t clausify_allocations = statistics.term_allocations;
+    ASSERT_GT(clausify_allocations, 0);
+
+    ResolutionOptions options;
+    options.statistics = &statistics;
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolution(clauses, history, options), ProofResult::PROVED);
+
+    ASSERT_GT(statistics.generated, 0);
+    ASSERT_LE(statistics.kept + statistics.subsumed + statistics.tautologies, statistics.generated);
+    ASSERT_GT(statistics.unification_attempts, 0);
+    ASSERT_LE(statistics.unification_successes, statistics.unification_attempts);
+    ASSERT_GE(statistics.index_hits, statistics.unification_attempts);
+    ASSERT_EQ(statistics.peak_clauses, clauses.size() + statistics.kept);
+    ASSERT_GT(statistics.term_allocations, clausify_allocations);
+    ASSERT_GE(statistics.peak_memory, statistics.peak_usage.terms);
+    ASSERT_GT(statistics.peak_usage.index, 0);
+
+    // counters add up over searches, the peak does not
+    ProofStatistics twice = statistics;
+    twice.Add(statistics);
+    ASSERT_EQ(twice.generated, 2 * statistics.generated);
+    ASSERT_EQ(twice.peak_clauses, statistics.peak_clauses);
+
+    DeleteHistory(history);
+    for (Formula *f : clauses) DeleteFormula(f);
+}
+
+TEST(ProverTest, BatchTest)
+{
+    std::vector<std::vector<std::string>> problems;
+    for (int i = 0; i < 20; ++i)
+    {
+        problems.push_back({"(forall x (implies (H x) (M x)))", "(H a)", "(not (M a))"});
+        problems.push_back({"(forall x (implies (H x) (M x)))", "(H a)"});
+    }
+    problems.push_back({"(H a"});
+
+    ProofStatistics statistics;
+    ResolutionOptions options;
+    options.statistics = &statistics;
+
+    std::vector<BatchResult> results;
+    MakeResolutionBatch(problems, results, 4, options);
+
+    ASSERT_EQ(results.size(), problems.size());
+    for (int i = 0; i < 40; ++i)
+    {
+        ASSERT_TRUE(results[i].error.empty());
+        if (i % 2 == 0)
+        {
+            ASSERT_EQ(results[i].result, ProofResult::PROVED);
+            ASSERT_EQ(std::get<2>(results[i].proof.back()), "□");
+        }
+        else
+        {
+            ASSERT_EQ(results[i].result, ProofResult::SATURATED);
+            ASSERT_TRUE(results[i].proof.empty());
+        }
+    }
+
+    ASSERT_FALSE(results.back().error.empty());
+
+    size_t generated = 0;
+    for (const BatchResult &result : results) generated += result.statistics.generated;
+    ASSERT_GT(generated, 0);
+    ASSERT_EQ(statistics.generated, generated);
+}
+
+TEST(ProverTest, SessionTest)
+{
+    ProverSession session;
+
+    session.AddPremise("(forall x (implies (H x) (M x)))");
+    session.AddPremise("(H a)");
+    session.AddGoal("(M a)");
+
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+    ASSERT_FALSE(session.Proof().empty());
+    ASSERT_EQ(FormulaAsString(session.Proof().back().resolvent), "□");
+
+    // the refutation is kept, proving again only extracts it
+    size_t steps = session.Proof().size();
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+    ASSERT_EQ(session.Proof().size(), steps);
+
+    ASSERT_THROW(session.AddPremise("(H b"), std::runtime_error);
+    ASSERT_EQ(session.Clauses().size(), 3);
+}
+
+TEST(ProverTest, SessionSkolemSymbolsTest)
+{
+    ProverSession session;
+
+    session.AddPremise("(exists x (P x))");
+    session.AddPremise("(exists x (Q x))");
+    session.AddPremise("(R a1)");
+    session.AddPremise("(exists x (S x))");
+
+    ASSERT_EQ(session.Clauses().size(), 4);
+    ASSERT_EQ(FormulaAsString(session.Clauses()[0]), "(P $a)");
+    ASSERT_EQ(FormulaAsString(session.Clauses()[1]), "(Q $a1)");
+    ASSERT_EQ(FormulaAsString(session.Clauses()[3]), "(S $a2)");
+
+    session.AddGoal("(P a1)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+}
+
+TEST(ProverTest, SessionLaterConstantTest)
+{
+    // a constant of a later premise is not the witness of an earlier one,
+    // the set is satisfiable
+    ProverSession session;
+    session.AddPremise("(exists x (P x))");
+    session.AddPremise("(not (P a))");
+
+    ASSERT_EQ(FormulaAsString(session.Clauses()[0]), "(P $a)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+}
+
+TEST(ProverTest, IncrementalSessionTest)
+{
+    ProverSession session;
+
+    session.AddPremise("(implies (H a) (M a))");
+    session.AddPremise("(implies (H b) (M b))");
+    session.AddPremise("(H a)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    SessionCheckpoint checkpoint = session.Checkpoint();
+
+    session.AddGoal("(M a)");
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+
+    // the goal and its refutation are retracted
+    session.Restore(checkpoint);
+    ASSERT_TRUE(session.Proof().empty());
+    ASSERT_EQ(session.Clauses().size(), 3);
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    session.AddGoal("(M b)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    session.AddPremise("(H b)");
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+    ASSERT_EQ(FormulaAsString(session.Proof().back().resolvent), "□");
+}
+
+TEST(ProverTest, IncrementalSkolemTest)
+{
+    ProverSession session;
+
+    session.AddPremise("(exists x (P x))");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    SessionCheckpoint checkpoint = session.Checkpoint();
+
+    // the witness is not a, whichever turn names a
+    session.AddGoal("(P a)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    session.Restore(checkpoint);
+    session.AddPremise("(forall x (implies (P x) (Q x)))");
+    session.AddGoal("(exists y (Q y))");
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+
+    session.Restore(checkpoint);
+    session.AddPremise("(exists x (R x))");
+    session.AddPremise("(not (R a1))");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+
+    session.AddGoal("(R b)");
+    ASSERT_EQ(session.Prove(), ProofResult::SATURATED);
+}
+
+TEST(ProverTest, ResumeSessionTest)
+{
+    ProverSession session;
+
+    session.AddPremise("(forall x (implies (P x) (Q x)))");
+    session.AddPremise("(forall y (implies (Q y) (R y)))");
+    session.AddPremise("(P a)");
+    session.AddGoal("(R a)");
+
+    ResolutionLimits limits;
+    limits.max_generated = 1;
+
+    // every call makes a bit of progress until the proof is found
+    int calls = 1;
+    while (session.Prove(limits) == ProofResult::UNKNOWN) calls++;
+
+    ASSERT_GT(calls, 1);
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+}
+
+TEST(ProverTest, SessionMemoryTest)
+{
+    // a long name costs its heap buffer on top of the nodes
+    std::string name(64, 'c');
+    Formula *atom  = Parser("(P a)").Parse();
+    Formula *named = Parser("(P " + name + ")").Parse();
+    size_t atom_bytes  = FormulaBytes(atom);
+    size_t named_bytes = FormulaBytes(named);
+    DeleteFormula(atom);
+    DeleteFormula(named);
+
+    ASSERT_GE(atom_bytes, 2 * sizeof(Formula));
+    ASSERT_GT(named_bytes, atom_bytes + name.size());
+
+    ProverSession session;
+    session.AddPremise("(forall x (implies (P x) (Q x)))");
+    session.AddPremise("(forall y (implies (Q y) (R y)))");
+    session.AddPremise("(P a)");
+    SessionCheckpoint checkpoint = session.Checkpoint();
+
+    session.AddGoal("(R a)");
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+
+    MemoryUsage live = session.Memory().Live();
+    ASSERT_GT(live.terms, 0);
+    ASSERT_GT(live.clauses, 0);
+    ASSERT_GT(live.index, 0);
+    ASSERT_GT(live.history, 0);
+    ASSERT_GE(session.Memory().Peak().terms, live.terms);
+    ASSERT_GE(session.Memory().PeakTotal(), live.Total());
+
+    // the goal, what was derived from it and the proof are released, the peak stays
+    session.Restore(checkpoint);
+    ASSERT_LT(session.Memory().Live().terms, live.terms);
+    ASSERT_EQ(session.Memory().Live().history, 0);
+    ASSERT_GE(session.Memory().PeakTotal(), live.Total());
+
+    // the budget is the total, the search stops once it is spent
+    ProverSession limited;
+    limited.AddPremise("(forall x (implies (P x) (Q x)))");
+    limited.AddPremise("(forall y (implies (Q y) (R y)))");
+    limited.AddPremise("(P a)");
+    limited.AddGoal("(R a)");
+
+    ResolutionLimits limits;
+    limits.max_memory = live.Total() - live.history - 1;
+    ASSERT_EQ(limited.Prove(limits), ProofResult::UNKNOWN);
+    ASSERT_GE(limited.Memory().Live().Total(), limits.max_memory);
+    ASSERT_EQ(limited.Prove(), ProofResult::PROVED);
+}
+
+TEST(ProverTest, ParallelSessionsTest)
+{
+    std::vector<ProofResult> results(8);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        threads.emplace_back([&results, i]
+        {
+            ProverSession session;
+
+            session.AddPremise("(forall x (implies (P x) (Q x)))");
+            session.AddPremise("(forall y (implies (Q y) (R y)))");
+            session.AddPremise("(P a)");
+            session.AddGoal(i % 2 == 0 ? "(R a)" : "(Q a)");
+
+            results[i] = session.Prove();
+        });
+    }
+
+    for (std::thread &thread : threads) thread.join();
+
+    for (ProofResult result : results) ASSERT_EQ(result, ProofResult::PROVED);
+}
+
+TEST(ProverTest, ProofDagTest)
+{
+    std::vector<Formula*> clauses;
+    ClausifyPremises({"(forall x (implies (P x) (Q x)))", "(forall y (implies (Q y) (R y)))",
+                      "(S b)", "(P a)", "(not (R a))"}, clauses);
+
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolution(clauses, history, ResolutionOptions()), ProofResult::PROVED);
+    size_t steps = history.size();
+
+    ProofDag dag(history);
+    ASSERT_TRUE(history.empty());
+
+    // the unused premise (S b) is not part of the proof
+    ASSERT_EQ(dag.Size(), 4 + steps);
+    ASSERT_EQ(dag.Clause(dag.Size() - 1)->type, FormulaType::EMPTY);
+
+    int premises = 0;
+    for (size_t i = 0; i < dag.Size(); ++i)
+    {
+        if (dag.Parent1(i) < 0)
+        {
+            premises++;
+            ASSERT_LT(dag.SearchId(i), clauses.size());
+            ASSERT_TRUE(FormulasEqual(dag.Clause(i), clauses[dag.SearchId(i)]));
+            continue;
+        }
+
+        ASSERT_LT(dag.Parent1(i), i);
+        ASSERT_LT(dag.Parent2(i), i);
+        ASSERT_EQ(dag.ParentData()[2 * i], dag.Parent1(i));
+    }
+    ASSERT_EQ(premises, 4);
+
+    for (Formula *f : clauses) DeleteFormula(f);
+}
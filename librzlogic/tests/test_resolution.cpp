@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "utils.hpp"
+#include <algorithm>
 
 using namespace rzlogic;
 
@@ -175,3 +176,182 @@ TEST(ResolutionTEST, ResolutionSimpleTest)
     DeleteFormula(f2);
     DeleteFormula(goal);
 }
+
+
+TEST(ResolutionTEST, ParallelResolutionTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Or(Not(Predicate("Q", {Var("y")})), Predicate("R", {Var("y")})),
+        Or(Predicate("S", {Const("b")}), Predicate("T", {Const("c")})),
+        Or(Not(Predicate("S", {Var("z")})), Predicate("T", {Var("z")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("R", {Const("a")}))
+    };
+
+    std::vector<ResolutionStepInfo> serial;
+    ASSERT_TRUE(MakeResolution(premises, serial));
+
+    for (int threads : {2, 4, 8})
+    {
+        ResolutionOptions options;
+        options.threads = threads;
+
+        std::vector<ResolutionStepInfo> parallel;
+        ASSERT_EQ(MakeResolution(premises, parallel, options), ProofResult::PROVED);
+        ASSERT_EQ(parallel.size(), serial.size());
+
+        for (size_t i = 0; i < serial.size(); ++i)
+        {
+            EXPECT_EQ(FormulaAsString(parallel[i].resolvent), FormulaAsString(serial[i].resolvent));
+        }
+        DeleteHistory(parallel);
+    }
+
+    DeleteHistory(serial);
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+TEST(ResolutionTEST, PortfolioResolutionTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Or(Not(Predicate("Q", {Var("y")})), Predicate("R", {Var("y")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("R", {Const("a")}))
+    };
+
+    ASSERT_EQ(PortfolioStrategies(12).size(), 12);
+
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolutionPortfolio(premises, history, 4), ProofResult::PROVED);
+    ASSERT_EQ(FormulaAsString(history.back().resolvent), "□");
+    DeleteHistory(history);
+
+    // (P a) is not refutable by itself
+    std::vector<Formula*> satisfiable = {premises[0], premises[2]};
+    ASSERT_EQ(MakeResolutionPortfolio(satisfiable, history, 4), ProofResult::SATURATED);
+    DeleteHistory(history);
+
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+
+TEST(ResolutionTEST, ResolutionLimitsTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Or(Not(Predicate("Q", {Var("y")})), Predicate("R", {Var("y")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("R", {Const("a")}))
+    };
+    std::vector<ResolutionStepInfo> history;
+
+    ResolutionOptions generated;
+    generated.limits.max_generated = 1;
+    ASSERT_EQ(MakeResolution(premises, history, generated), ProofResult::UNKNOWN);
+    DeleteHistory(history);
+
+    ResolutionOptions memory;
+    memory.limits.max_memory = 1;
+    ASSERT_EQ(MakeResolution(premises, history, memory), ProofResult::UNKNOWN);
+    DeleteHistory(history);
+
+    ResolutionOptions cancelled;
+    cancelled.cancel.Child().Cancel();
+    ASSERT_FALSE(cancelled.cancel.IsCancelled());
+    cancelled.cancel.Cancel();
+    ASSERT_EQ(MakeResolution(premises, history, cancelled), ProofResult::UNKNOWN);
+    ASSERT_EQ(MakeResolutionPortfolio(premises, history, 3, cancelled), ProofResult::UNKNOWN);
+    DeleteHistory(history);
+
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+TEST(ResolutionTEST, TermDepthLimitTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Not(Predicate("P", {Const("a")})), Predicate("Q", {Function("f", {Function("g", {Const("a")})})})),
+        Predicate("P", {Const("a")})
+    };
+    std::vector<ResolutionStepInfo> history;
+
+    ASSERT_EQ(TermDepth(premises[0]), 2);
+    ASSERT_EQ(MakeResolution(premises, history, ResolutionOptions()), ProofResult::SATURATED);
+    DeleteHistory(history);
+
+    // the only resolvent is too deep, so saturation is not conclusive
+    ResolutionOptions options;
+    options.limits.max_term_depth = 1;
+    ASSERT_EQ(MakeResolution(premises, history, options), ProofResult::UNKNOWN);
+    ASSERT_TRUE(history.empty());
+
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+
+TEST(ResolutionTEST, ProofExtractionTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Predicate("S", {Const("b")}), Predicate("T", {Const("c")})),
+        Or(Not(Predicate("S", {Var("z")})), Predicate("T", {Var("z")})),
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("Q", {Const("a")}))
+    };
+    std::vector<ResolutionStepInfo> history;
+
+    ASSERT_EQ(MakeResolution(premises, history, ResolutionOptions()), ProofResult::PROVED);
+
+    // only the inferences leading to the empty clause are reported
+    ASSERT_EQ(history.size(), 2);
+    ASSERT_EQ(history[0].premise1_id, 2);
+    ASSERT_EQ(history[0].premise2_id, 4);
+    ASSERT_EQ(FormulaAsString(history[1].resolvent), "□");
+    ASSERT_EQ(history[1].premise1_id, 3);
+    ASSERT_EQ(history[1].premise2_id, history[0].resolvent_id);
+
+    DeleteHistory(history);
+    for (Formula *f : premises) DeleteFormula(f);
+}
+
+TEST(ResolutionTEST, ProgressTest)
+{
+    std::vector<Formula*> premises = {
+        Or(Not(Predicate("P", {Var("x")})), Predicate("Q", {Var("x")})),
+        Or(Not(Predicate("Q", {Var("y")})), Predicate("R", {Var("y")})),
+        Predicate("P", {Const("a")}),
+        Not(Predicate("R", {Const("a")}))
+    };
+    std::vector<ResolutionStepInfo> history;
+    std::vector<ProgressInfo> reports;
+    std::vector<std::string> units;
+
+    // interval 0 reports before every given clause
+    ResolutionOptions options;
+    options.progress_interval = 0;
+    options.progress = [&](const ProgressInfo &info)
+    {
+        reports.push_back(info);
+        for (Formula *unit : info.units) units.push_back(FormulaAsString(unit));
+    };
+
+    ASSERT_EQ(MakeResolution(premises, history, options), ProofResult::PROVED);
+    ASSERT_GT(reports.size(), 2);
+    ASSERT_EQ(reports.front().clauses, premises.size());
+    ASSERT_EQ(reports.front().passive, premises.size());
+    ASSERT_GT(reports.front().memory, 0);
+
+    for (size_t i = 1; i < reports.size(); ++i)
+    {
+        ASSERT_GE(reports[i].generated, reports[i - 1].generated);
+        ASSERT_GE(reports[i].kept, reports[i - 1].kept);
+    }
+
+    // the last report comes after the refutation
+    ASSERT_EQ(reports.back().clauses, premises.size() + reports.back().kept);
+    ASSERT_NE(std::find(units.begin(), units.end(), "□"), units.end());
+
+    DeleteHistory(history);
+    for (Formula *f : premises) DeleteFormula(f);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "server.hpp"
+#include <thread>
+
+using namespace rzlogic;
+
+static ServerOptions TestServerOptions(const std::string &name)
+{
+    ServerOptions options;
+    options.socket_path = testing::TempDir() + name;
+    options.threads     = 2;
+    return options;
+}
+
+static bool StartsWith(const std::string &str, const std::string &prefix)
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+TEST(ServerTest, ProveTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_prove.sock");
+    ProofServer server(options);
+    server.Start();
+
+    ProofClient client(options.socket_path);
+    std::string request = "prove\n"
+                          "premise (forall x (implies (H x) (M x)))\n"
+                          "premise (H a)\n"
+                          "goal (M a)\n";
+
+    std::string response = client.Request(request);
+    ASSERT_TRUE(StartsWith(response, "ok proved\nstep ")) << response;
+    ASSERT_NE(response.find("\t□\n"), std::string::npos);
+
+    // the second time comes from the cache
+    ASSERT_EQ(client.Request(request), response);
+
+    std::string stats = client.Request("stats");
+    ASSERT_NE(stats.find("cache_hits 1\n"), std::string::npos) << stats;
+    ASSERT_NE(stats.find("requests 3\n"), std::string::npos) << stats;
+
+    ASSERT_EQ(client.Request("prove\npremise (P a)\npremise (Q b)\n"), "ok saturated\n");
+}
+
+TEST(ServerTest, CachedProofTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_cached.sock");
+    ProofServer server(options);
+    server.Start();
+
+    ProofClient client(options.socket_path);
+    std::string response = client.Request("prove\n"
+                                          "premise (forall x (implies (H x) (M x)))\n"
+                                          "premise (H a)\n"
+                                          "goal (M a)\n");
+    ASSERT_TRUE(StartsWith(response, "ok proved\n")) << response;
+
+    // reordered premises share the entry, its steps name the same clauses
+    ASSERT_EQ(client.Request("prove\n"
+                             "premise (H a)\n"
+                             "premise (forall x (implies (H x) (M x)))\n"
+                             "goal (M a)\n"), response);
+
+    // a renamed variable shares it too, the steps show the new name
+    std::string renamed = client.Request("prove\n"
+                                         "premise (H a)\n"
+                                         "premise (forall y (implies (H y) (M y)))\n"
+                                         "goal (M a)\n");
+    ASSERT_TRUE(StartsWith(renamed, "ok proved\n")) << renamed;
+    ASSERT_NE(renamed.find(" y)"), std::string::npos) << renamed;
+    ASSERT_EQ(renamed.find(" x)"), std::string::npos) << renamed;
+
+    std::string stats = client.Request("stats");
+    ASSERT_NE(stats.find("cache_hits 2\n"), std::string::npos) << stats;
+    ASSERT_NE(stats.find("cache_misses 1\n"), std::string::npos) << stats;
+}
+
+TEST(ServerTest, TheoryTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_theory.sock");
+    ProofServer server(options);
+    server.Start();
+
+    ProofClient client(options.socket_path);
+    ASSERT_EQ(client.Request("load animals\n"
+                             "premise (forall x (implies (Dog x) (Animal x)))\n"
+                             "premise (forall x (implies (Animal x) (Mortal x)))\n"
+                             "saturate\n"), "ok\n");
+
+    ASSERT_TRUE(StartsWith(client.Request("prove\ntheory animals\npremise (Dog rex)\ngoal (Mortal rex)\n"), "ok proved\n"));
+    ASSERT_EQ(client.Request("prove\ntheory animals\npremise (Dog rex)\ngoal (Cat rex)\n"), "ok saturated\n");
+
+    // the witness of a theory is none of the constants of a request
+    ASSERT_EQ(client.Request("load someone\npremise (exists x (Dog x))\nsaturate\n"), "ok\n");
+    ASSERT_EQ(client.Request("prove\ntheory someone\ngoal (Dog bob)\n"), "ok saturated\n");
+    ASSERT_EQ(client.Request("prove\ntheory someone\ngoal (exists x (Dog x))\n").rfind("ok proved\n", 0), 0);
+
+    ASSERT_EQ(client.Request("drop animals"), "ok\n");
+    ASSERT_TRUE(StartsWith(client.Request("prove\ntheory animals\ngoal (Mortal rex)\n"), "error Unknown theory"));
+}
+
+TEST(ServerTest, BadRequestTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_errors.sock");
+    ProofServer server(options);
+    server.Start();
+
+    ProofClient client(options.socket_path);
+    ASSERT_TRUE(StartsWith(client.Request("hello"), "error Unknown command"));
+    ASSERT_TRUE(StartsWith(client.Request("prove\npremise (P a\n"), "error "));
+    ASSERT_TRUE(StartsWith(client.Request("prove\npremise (P a)\ntimeout soon\n"), "error Bad value of timeout"));
+
+    // the connection survives errors
+    ASSERT_TRUE(StartsWith(client.Request("stats"), "ok\n"));
+}
+
+TEST(ServerTest, ConcurrentClientsTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_clients.sock");
+    ProofServer server(options);
+    server.Start();
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> responses(8);
+
+    for (size_t i = 0; i < responses.size(); ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            ProofClient client(options.socket_path);
+            std::string c = "c" + std::to_string(i);
+            responses[i] = client.Request("prove\npremise (implies (P " + c + ") (Q " + c + "))\n"
+                                          "premise (P " + c + ")\ngoal (Q " + c + ")\n");
+        });
+    }
+    for (std::thread &thread : threads) thread.join();
+
+    for (const std::string &response : responses) ASSERT_TRUE(StartsWith(response, "ok proved\n")) << response;
+}
+
+TEST(ServerTest, StopTest)
+{
+    ServerOptions options = TestServerOptions("rzlogic_stop.sock");
+    ProofServer server(options);
+    server.Start();
+
+    ProofClient client(options.socket_path);
+    ASSERT_TRUE(StartsWith(client.Request("stats"), "ok\n"));
+
+    server.Stop();
+    ASSERT_THROW(client.Request("stats"), std::runtime_error);
+    ASSERT_THROW(ProofClient(options.socket_path), std::runtime_error);
+}
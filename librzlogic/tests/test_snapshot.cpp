@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "prover.hpp"
+#include "snapshot.hpp"
+#include <fstream>
+
+using namespace rzlogic;
+
+static void AddTheory(ProverSession &session)
+{
+    session.AddPremise("(forall x (implies (P x) (Q x)))");
+    session.AddPremise("(forall y (implies (Q y) (R y)))");
+    session.AddPremise("(exists x (S x))");
+    session.AddPremise("(P a)");
+}
+
+TEST(SnapshotTest, MappedFileTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_mapped.bin";
+    std::ofstream(path) << "mapped";
+
+    MappedFile file(path);
+    ASSERT_EQ(std::string(file.Data(), file.Size()), "mapped");
+
+    ASSERT_THROW(MappedFile(path + ".missing"), std::runtime_error);
+}
+
+TEST(SnapshotTest, SaturatedSnapshotTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_theory.snap";
+
+    ProverSession original;
+    AddTheory(original);
+    ASSERT_EQ(original.Prove(), ProofResult::SATURATED);
+    original.SaveSnapshot(path);
+
+    ProverSession loaded;
+    loaded.LoadSnapshot(path);
+
+    ASSERT_EQ(loaded.Clauses().size(), original.Clauses().size());
+    for (size_t i = 0; i < loaded.Clauses().size(); ++i)
+    {
+        ASSERT_TRUE(FormulasEqual(loaded.Clauses()[i], original.Clauses()[i]));
+    }
+
+    // the loaded session goes on exactly where the original stopped
+    original.AddGoal("(R a)");
+    loaded.AddGoal("(R a)");
+    ASSERT_EQ(original.Prove(), ProofResult::PROVED);
+    ASSERT_EQ(loaded.Prove(), ProofResult::PROVED);
+
+    ASSERT_EQ(loaded.Proof().size(), original.Proof().size());
+    for (size_t i = 0; i < loaded.Proof().size(); ++i)
+    {
+        ASSERT_EQ(loaded.Proof()[i].resolvent_id, original.Proof()[i].resolvent_id);
+        ASSERT_TRUE(FormulasEqual(loaded.Proof()[i].resolvent, original.Proof()[i].resolvent));
+    }
+
+    // the symbol table came along, new Skolem constants do not clash
+    loaded.AddPremise("(exists x (T x))");
+    ASSERT_EQ(FormulaAsString(loaded.Clauses().back()), "(T $a1)");
+
+    ASSERT_THROW(loaded.LoadSnapshot(path), std::runtime_error);
+}
+
+TEST(SnapshotTest, ClausesOnlySnapshotTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_clauses.snap";
+
+    ProverSession original;
+    AddTheory(original);
+    original.SaveSnapshot(path, false);
+
+    ProverSession loaded;
+    loaded.LoadSnapshot(path);
+    loaded.AddGoal("(Q a)");
+
+    ASSERT_EQ(loaded.Clauses().size(), 5);
+    ASSERT_EQ(loaded.Prove(), ProofResult::PROVED);
+}
+
+TEST(SnapshotTest, BrokenSnapshotTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_broken.snap";
+
+    std::ofstream(path) << "RZPL garbage";
+    ProverSession session;
+    ASSERT_THROW(session.LoadSnapshot(path), std::runtime_error);
+
+    // a truncated snapshot is rejected and leaves the session empty
+    ProverSession original;
+    AddTheory(original);
+    original.Prove();
+    original.SaveSnapshot(path);
+
+    std::string content;
+    {
+        std::ifstream in(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary) << content.substr(0, content.size() - 3);
+
+    ASSERT_THROW(session.LoadSnapshot(path), std::runtime_error);
+    ASSERT_TRUE(session.Clauses().empty());
+}
+
+TEST(SnapshotTest, SerializedSessionTest)
+{
+    ProverSession original;
+    AddTheory(original);
+    original.AddGoal("(R a)");
+    ASSERT_EQ(original.Prove(), ProofResult::PROVED);
+
+    std::string buffer = original.Serialize();
+
+    ProverSession copy;
+    copy.Deserialize(buffer.data(), buffer.size());
+    ASSERT_EQ(copy.Clauses().size(), original.Clauses().size());
+    ASSERT_EQ(copy.Prove(), ProofResult::PROVED);
+    ASSERT_EQ(copy.Serialize(), buffer);
+
+    // every truncation is rejected
+    for (size_t size = 0; size < buffer.size(); ++size)
+    {
+        ProverSession broken;
+        ASSERT_THROW(broken.Deserialize(buffer.data(), size), std::runtime_error);
+        ASSERT_TRUE(broken.Clauses().empty());
+    }
+}
+
+TEST(SnapshotTest, SerializedProofTest)
+{
+    ProverSession session;
+    AddTheory(session);
+    session.AddGoal("(R a)");
+    ASSERT_EQ(session.Prove(), ProofResult::PROVED);
+
+    std::vector<ResolutionStepInfo> steps;
+    for (const ResolutionStepInfo &step : session.Proof())
+    {
+        ResolutionStepInfo copy = step;
+        copy.premise1  = CloneFormula(step.premise1);
+        copy.premise2  = CloneFormula(step.premise2);
+        copy.resolvent = CloneFormula(step.resolvent);
+        steps.push_back(copy);
+    }
+    ProofDag proof(steps);
+
+    std::string buffer = SerializeProof(proof);
+    std::unique_ptr<ProofDag> copy = DeserializeProof(buffer.data(), buffer.size());
+
+    ASSERT_EQ(copy->Size(), proof.Size());
+    for (size_t i = 0; i < proof.Size(); ++i)
+    {
+        ASSERT_TRUE(FormulasEqual(copy->Clause(i), proof.Clause(i)));
+        ASSERT_EQ(copy->Parent1(i), proof.Parent1(i));
+        ASSERT_EQ(copy->Parent2(i), proof.Parent2(i));
+        ASSERT_EQ(copy->SearchId(i), proof.SearchId(i));
+    }
+
+    ASSERT_THROW(DeserializeProof(buffer.data(), buffer.size() - 1), std::runtime_error);
+    ASSERT_THROW(DeserializeProof("RZSN", 4), std::runtime_error);
+}
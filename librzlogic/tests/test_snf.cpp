@@ -41,3 +41,19 @@ TEST(FormsTest, MakeSkolemNormalFormTest)
 
     DeleteFormula(f);
 }
+
+TEST(FormsTest, RepeatedSkolemFunctionTest)
+{
+    Formula *f = ForAll("y", Exists("x", And(Predicate("Q", {Var("x")}), Predicate("P", {Var("x")}))));
+
+    MakeSkolemNormalForm(f);
+
+    ASSERT_EQ(FormulaAsString(f), "(and (Q (n y)) (P (n y)))");
+
+    // both occurrences own their arguments
+    Formula *term1 = f->children[0]->children[0];
+    Formula *term2 = f->children[1]->children[0];
+    ASSERT_NE(term1->children[0], term2->children[0]);
+
+    DeleteFormula(f);
+}
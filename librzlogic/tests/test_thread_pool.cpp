@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "thread_pool.hpp"
+#include <atomic>
+#include <stdexcept>
+
+using namespace rzlogic;
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndex)
+{
+    ThreadPool pool(4);
+    std::vector<int> visited(1000, 0);
+
+    pool.ParallelFor(visited.size(), [&visited](size_t i) { visited[i]++; });
+
+    for (int count : visited) {
+        ASSERT_EQ(count, 1);
+    }
+}
+
+TEST(ThreadPoolTest, NestedParallelFor)
+{
+    ThreadPool pool(2);
+    std::atomic<int> sum{0};
+
+    pool.ParallelFor(8, [&pool, &sum](size_t) {
+        pool.ParallelFor(8, [&sum](size_t j) { sum += j; });
+    });
+
+    ASSERT_EQ(sum, 8 * 28);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrows)
+{
+    ThreadPool pool(3);
+
+    ASSERT_THROW(pool.ParallelFor(10, [](size_t i) {
+        if (i == 7) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, SubmitKeepsExceptions)
+{
+    ThreadPool pool(2);
+
+    std::future<void> failed = pool.Submit([] { throw std::runtime_error("task failed"); });
+    ASSERT_THROW(failed.get(), std::runtime_error);
+
+    // a lost exception does not take the pool down
+    pool.Submit([] { throw std::runtime_error("nobody waits"); });
+
+    std::atomic<int> done{0};
+    pool.Submit([&done] { done++; }).get();
+    ASSERT_EQ(done, 1);
+
+    ThreadPool inline_pool(0);
+    ASSERT_THROW(inline_pool.Submit([] { throw std::runtime_error("inline"); }).get(), std::runtime_error);
+}
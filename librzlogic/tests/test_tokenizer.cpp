@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "tokenizer.hpp"
+#include <cctype>
+#include <random>
+
+using namespace rzlogic;
+
+static std::vector<std::string> Tokens(const std::string &text, bool comments, ScanKernel kernel)
+{
+    Tokenizer tokenizer(text.data(), text.size(), comments, kernel);
+
+    std::vector<std::string> tokens;
+    for (Token token = tokenizer.Next(); token.type != TokenType::END; token = tokenizer.Next())
+    {
+        EXPECT_GE(token.text.data(), text.data());
+        std::string prefix = token.type == TokenType::INVALID ? "!" : "";
+        tokens.push_back(prefix + std::string(token.text));
+    }
+    return tokens;
+}
+
+// byte at a time, what every kernel has to agree with
+static std::vector<std::string> ReferenceTokens(const std::string &text, bool comments)
+{
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < text.size(); )
+    {
+        unsigned char c = text[i];
+        if (isspace(c)) {
+            i++;
+        }
+        else if (comments && c == '#') {
+            while (i < text.size() && text[i] != '\n') i++;
+        }
+        else if (c == '(' || c == ')') {
+            tokens.push_back(std::string(1, c));
+            i++;
+        }
+        else if (isalnum(c))
+        {
+            size_t start = i;
+            while (i < text.size() && isalnum((unsigned char)text[i])) i++;
+            tokens.push_back(text.substr(start, i - start));
+        }
+        else {
+            tokens.push_back("!" + std::string(1, c));
+            i++;
+        }
+    }
+    return tokens;
+}
+
+static std::vector<ScanKernel> Kernels()
+{
+    std::vector<ScanKernel> kernels = {ScanKernel::SCALAR};
+    if (BestScanKernel() >= ScanKernel::SSE2) kernels.push_back(ScanKernel::SSE2);
+    if (BestScanKernel() >= ScanKernel::AVX2) kernels.push_back(ScanKernel::AVX2);
+    return kernels;
+}
+
+TEST(TokenizerTest, TokensTest)
+{
+    std::string text = "(forall x\t(implies (Human x)\r\n (Mortal x))) # all of them\n(P a1, b)";
+
+    for (ScanKernel kernel : Kernels())
+    {
+        std::vector<std::string> expected = {"(", "forall", "x", "(", "implies", "(", "Human", "x", ")",
+                                             "(", "Mortal", "x", ")", ")", ")", "!#", "all", "of", "them",
+                                             "(", "P", "a1", "!,", "b", ")"};
+        ASSERT_EQ(Tokens(text, false, kernel), expected) << ScanKernelName(kernel);
+
+        expected.erase(expected.begin() + 15, expected.begin() + 19);
+        ASSERT_EQ(Tokens(text, true, kernel), expected) << ScanKernelName(kernel);
+
+        ASSERT_TRUE(Tokens("", true, kernel).empty());
+        ASSERT_TRUE(Tokens(" \n\t# only a comment", true, kernel).empty());
+    }
+
+    // END stays
+    Tokenizer tokenizer("a", 1);
+    ASSERT_EQ(tokenizer.Next().text, "a");
+    ASSERT_EQ(tokenizer.Next().type, TokenType::END);
+    ASSERT_EQ(tokenizer.Next().type, TokenType::END);
+}
+
+TEST(TokenizerTest, KernelsAgreeTest)
+{
+    // identifiers and comments across block edges, bytes of every class
+    const std::string pieces[] = {"(", ")", " ", "\t", "\n", "\v", "x", "Pred0", "#", ",", "\xe9",
+                                  std::string(70, 'a'), std::string(130, ' '), "# comment\n"};
+
+    std::mt19937 random(42);
+    for (int round = 0; round < 200; round++)
+    {
+        std::string text;
+        size_t length = random() % 600;
+        while (text.size() < length) text += pieces[random() % std::size(pieces)];
+
+        for (bool comments : {false, true})
+        {
+            std::vector<std::string> expected = ReferenceTokens(text, comments);
+            for (ScanKernel kernel : Kernels()) {
+                ASSERT_EQ(Tokens(text, comments, kernel), expected) << ScanKernelName(kernel) << " on " << text;
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "prover.hpp"
+#include "tptp.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace rzlogic;
+
+static void DeleteAll(std::vector<TptpFormula> &formulas)
+{
+    for (TptpFormula &formula : formulas) DeleteFormula(formula.formula);
+}
+
+static std::vector<TptpFormula> ReadAll(const std::string &text)
+{
+    std::istringstream in(text);
+    TptpReader reader(in, "test.p");
+
+    std::vector<TptpFormula> formulas;
+    try
+    {
+        for (TptpFormula formula; reader.Next(formula); ) formulas.push_back(formula);
+    }
+    catch (...)
+    {
+        DeleteAll(formulas);
+        throw;
+    }
+    return formulas;
+}
+
+static void WriteFile(const std::string &path, const std::string &text)
+{
+    std::ofstream(path) << text;
+}
+
+TEST(TptpTest, CnfTest)
+{
+    std::vector<TptpFormula> formulas = ReadAll(
+        "% a comment\n"
+        "cnf(c1, axiom, ~ human(X) | mortal(X)).\n"
+        "/* a block\n comment */\n"
+        "cnf(c2, hypothesis, (human(socrates))).\n"
+        "cnf(c3, negated_conjecture, ~mortal(socrates), file('x.p', c3)).\n");
+
+    ASSERT_EQ(formulas.size(), 3);
+    ASSERT_EQ(formulas[0].name, "c1");
+    ASSERT_EQ(formulas[0].role, "axiom");
+    ASSERT_EQ(FormulaAsString(formulas[0].formula), "(or (not (human X)) (mortal X))");
+    ASSERT_EQ(formulas[0].formula->children[0]->children[0]->children[0]->type, FormulaType::VARIABLE);
+    ASSERT_EQ(FormulaAsString(formulas[1].formula), "(human socrates)");
+    ASSERT_EQ(formulas[1].formula->children[0]->type, FormulaType::CONSTANT);
+    ASSERT_EQ(formulas[2].role, "negated_conjecture");
+    ASSERT_EQ(FormulaAsString(formulas[2].formula), "(not (mortal socrates))");
+
+    DeleteAll(formulas);
+}
+
+TEST(TptpTest, FofTest)
+{
+    std::vector<TptpFormula> formulas = ReadAll(
+        "fof(quantifiers, axiom, ! [X, Y] : ? [Z] : (p(X) & q(Y) & r(f(X, Y), Z))).\n"
+        "fof(implications, axiom, (a => b) & (c <= d)).\n"
+        "fof(equivalence, axiom, a <=> ~b).\n"
+        "fof(equality, axiom, f(a) != b | a = 'quoted name').\n");
+
+    ASSERT_EQ(formulas.size(), 4);
+    ASSERT_EQ(FormulaAsString(formulas[0].formula),
+              "(forall X (forall Y (exists Z (and (and (p X) (q Y)) (r (f X Y) Z)))))");
+    ASSERT_EQ(FormulaAsString(formulas[1].formula), "(and (implies (a) (b)) (implies (d) (c)))");
+    ASSERT_EQ(FormulaAsString(formulas[2].formula), "(and (implies (a) (not (b))) (implies (not (b)) (a)))");
+    ASSERT_EQ(FormulaAsString(formulas[3].formula), "(or (not (= (f a) b)) (= a quoted name))");
+
+    DeleteAll(formulas);
+}
+
+TEST(TptpTest, ErrorTest)
+{
+    try
+    {
+        ReadAll("cnf(c1, axiom, p(a)).\n\ncnf(c2, axiom, p(a) |).\n");
+        FAIL();
+    }
+    catch (const std::runtime_error &e) {
+        ASSERT_EQ(std::string(e.what()).rfind("test.p:3: ", 0), 0) << e.what();
+    }
+
+    ASSERT_THROW(ReadAll("tff(t, type, a: $i)."), std::runtime_error);
+    ASSERT_THROW(ReadAll("cnf(c1, axiom, $false)."), std::runtime_error);
+    ASSERT_THROW(ReadAll("cnf(c1, axiom, p(a))"), std::runtime_error);
+    ASSERT_THROW(ReadAll("include('missing.ax')."), std::runtime_error);
+}
+
+TEST(TptpTest, IncludeTest)
+{
+    std::string root = testing::TempDir() + "rzlogic_tptp/";
+    std::filesystem::create_directories(root + "Axioms");
+    std::filesystem::create_directories(root + "Problems");
+
+    WriteFile(root + "Axioms/ANI000-0.ax",
+              "fof(dogs, axiom, ! [X] : (dog(X) => animal(X))).\n"
+              "fof(animals, axiom, ! [X] : (animal(X) => mortal(X))).\n"
+              "fof(cats, axiom, ! [X] : (cat(X) => animal(X))).\n");
+    WriteFile(root + "Problems/ANI001-1.p",
+              "include('Axioms/ANI000-0.ax', [dogs, animals]).\n"
+              "fof(rex, axiom, dog(rex)).\n"
+              "fof(goal, conjecture, mortal(rex)).\n");
+
+    std::vector<Formula*> premises;
+    ReadTptpProblem(root + "Problems/ANI001-1.p", premises, root);
+
+    ASSERT_EQ(premises.size(), 4);
+    ASSERT_EQ(FormulaAsString(premises[0]), "(forall X (implies (dog X) (animal X)))");
+    ASSERT_EQ(FormulaAsString(premises[3]), "(not (mortal rex))");
+
+    std::vector<Formula*> clauses;
+    ClausifyFormulas(premises, clauses);
+    ASSERT_TRUE(premises.empty());
+
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolution(clauses, history, ResolutionOptions()), ProofResult::PROVED);
+
+    DeleteHistory(history);
+    for (Formula *f : clauses) DeleteFormula(f);
+
+    // without the root the include is looked up next to the problem
+    ASSERT_THROW(ReadTptpProblem(root + "Problems/ANI001-1.p", premises, ""), std::runtime_error);
+    ASSERT_TRUE(premises.empty());
+}
+
+TEST(TptpTest, SkolemSymbolsTest)
+{
+    // Skolem constants start with $, they cannot be constants of the problem
+    std::vector<TptpFormula> formulas = ReadAll(
+        "fof(f1, axiom, ? [X] : p(X)).\n"
+        "fof(f2, axiom, ~p(a)).\n");
+
+    std::vector<Formula*> premises = {formulas[0].formula, formulas[1].formula};
+    std::vector<Formula*> clauses;
+    ClausifyFormulas(premises, clauses);
+
+    ASSERT_EQ(clauses.size(), 2);
+    ASSERT_NE(FormulaAsString(clauses[0]), "(p a)");
+
+    std::vector<ResolutionStepInfo> history;
+    ASSERT_EQ(MakeResolution(clauses, history, ResolutionOptions()), ProofResult::SATURATED);
+
+    DeleteHistory(history);
+    for (Formula *f : clauses) DeleteFormula(f);
+}
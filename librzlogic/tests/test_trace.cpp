@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "prover.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace rzlogic;
+
+static size_t Count(const std::string &text, const std::string &what)
+{
+    size_t count = 0;
+    for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1)) count++;
+    return count;
+}
+
+TEST(TraceTest, WriteTraceTest)
+{
+    std::string path = testing::TempDir() + "rzlogic_trace.json";
+
+    if (!TracingAvailable())
+    {
+        ASSERT_THROW(WriteTrace(path), std::runtime_error);
+        GTEST_SKIP() << "built without RZLOGIC_TRACING";
+    }
+
+    StartTracing();
+
+    std::vector<std::string> premises = {"(forall x (implies (P x) (Q x)))", "(forall y (implies (Q y) (R y)))",
+                                         "(exists z (P z))", "(not (R a))"};
+    std::vector<Formula*> clauses;
+    ThreadPool pool(2);
+    ClausifyPremises(premises, clauses, &pool);
+
+    std::vector<ResolutionStepInfo> history;
+    MakeResolution(clauses, history, ResolutionOptions());
+
+    StopTracing();
+    WriteTrace(path);
+
+    // not recorded any more
+    ClausifyPremises(premises, clauses);
+
+    std::stringstream trace;
+    trace << std::ifstream(path).rdbuf();
+    std::string text = trace.str();
+
+    ASSERT_EQ(text.rfind("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", 0), 0);
+    ASSERT_EQ(text.substr(text.size() - 4), "\n]}\n");
+    ASSERT_EQ(Count(text, "\"name\": \"parse\", \"ph\": \"X\""), premises.size());
+    ASSERT_EQ(Count(text, "\"name\": \"skolem\""), 1);
+    ASSERT_EQ(Count(text, "\"name\": \"saturate\""), 1);
+    ASSERT_GT(Count(text, "\"name\": \"given clause\""), 0);
+    ASSERT_GT(Count(text, "\"name\": \"clauses\", \"ph\": \"C\""), 0);
+
+    // a new trace drops the old events
+    StartTracing();
+    StopTracing();
+    WriteTrace(path);
+
+    trace.str("");
+    trace << std::ifstream(path).rdbuf();
+    ASSERT_EQ(Count(trace.str(), "\"ph\": \"X\""), 0);
+
+    DeleteHistory(history);
+    for (Formula *f : clauses) DeleteFormula(f);
+}